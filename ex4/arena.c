@@ -0,0 +1,142 @@
+#include "arena.h"
+
+/**
+ * rounds size up to a multiple of ARENA_ALIGN (at least ARENA_ALIGN)
+ */
+static size_t round_up (size_t size)
+{
+  if (size == 0)
+    {
+      return ARENA_ALIGN;
+    }
+  return (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+void slab_pool_init (slab_pool *pool, size_t block_size)
+{
+  pool->block_size = round_up (block_size);
+  pool->free_list = NULL;
+  pool->slabs = NULL;
+  pool->bump = NULL;
+  pool->bump_left = 0;
+}
+
+void *slab_pool_get (slab_pool *pool)
+{
+  void *block;
+  if (pool->free_list != NULL)
+    {
+      block = pool->free_list;
+      pool->free_list = *(void **) block;
+      return block;
+    }
+  if (pool->bump_left == 0)
+    {
+      size_t n_blocks = ARENA_SLAB_SIZE / pool->block_size;
+      n_blocks = n_blocks == 0 ? 1 : n_blocks;
+      arena_slab *slab = (arena_slab *) malloc (sizeof (arena_slab)
+                                                + n_blocks * pool->block_size);
+      if (slab == NULL)
+        {
+          return NULL;
+        }
+      slab->next = pool->slabs;
+      pool->slabs = slab;
+      pool->bump = (char *) (slab + 1);
+      pool->bump_left = n_blocks;
+    }
+  block = pool->bump;
+  pool->bump += pool->block_size;
+  --pool->bump_left;
+  return block;
+}
+
+void slab_pool_put (slab_pool *pool, void *block)
+{
+  if (block == NULL)
+    {
+      return;
+    }
+  *(void **) block = pool->free_list;
+  pool->free_list = block;
+}
+
+void slab_pool_release (slab_pool *pool)
+{
+  arena_slab *next;
+  while (pool->slabs != NULL)
+    {
+      next = pool->slabs->next;
+      free (pool->slabs);
+      pool->slabs = next;
+    }
+  pool->free_list = NULL;
+  pool->bump = NULL;
+  pool->bump_left = 0;
+}
+
+/**
+ * vector_allocator alloc of an arena
+ */
+static void *arena_vector_alloc (void *ctx, size_t size)
+{
+  return arena_get ((arena *) ctx, size);
+}
+
+/**
+ * vector_allocator free of an arena
+ */
+static void arena_vector_free (void *ctx, void *ptr, size_t size)
+{
+  arena_put ((arena *) ctx, ptr, size);
+}
+
+arena *arena_alloc (void)
+{
+  arena *new_arena = (arena *) malloc (sizeof (arena));
+  if (new_arena == NULL)
+    {
+      return NULL;
+    }
+  for (size_t i = 0; i < ARENA_N_POOLS; ++i)
+    {
+      slab_pool_init (&(new_arena->pools[i]), (i + 1) * ARENA_ALIGN);
+    }
+  new_arena->vector_allocator.alloc = arena_vector_alloc;
+  new_arena->vector_allocator.free = arena_vector_free;
+  new_arena->vector_allocator.ctx = new_arena;
+  return new_arena;
+}
+
+void arena_free (arena **p_arena)
+{
+  if (p_arena == NULL || *p_arena == NULL)
+    {
+      return;
+    }
+  for (size_t i = 0; i < ARENA_N_POOLS; ++i)
+    {
+      slab_pool_release (&((*p_arena)->pools[i]));
+    }
+  free (*p_arena);
+  *p_arena = NULL;
+}
+
+void *arena_get (arena *arena, size_t size)
+{
+  if (size > ARENA_MAX_BLOCK)
+    {
+      return malloc (size);
+    }
+  return slab_pool_get (&(arena->pools[round_up (size) / ARENA_ALIGN - 1]));
+}
+
+void arena_put (arena *arena, void *ptr, size_t size)
+{
+  if (size > ARENA_MAX_BLOCK)
+    {
+      free (ptr);
+      return;
+    }
+  slab_pool_put (&(arena->pools[round_up (size) / ARENA_ALIGN - 1]), ptr);
+}
@@ -0,0 +1,133 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stdlib.h>
+#include "vector.h"
+
+/**
+ * @def ARENA_SLAB_SIZE
+ * The number of bytes a slab pool takes from malloc at once.
+ */
+#define ARENA_SLAB_SIZE 65536UL
+
+/**
+ * @def ARENA_ALIGN
+ * The alignment (and granularity) of the blocks of an arena.
+ */
+#define ARENA_ALIGN 16UL
+
+/**
+ * @def ARENA_MAX_BLOCK
+ * The largest block an arena serves from its pools, larger requests go
+ * straight to malloc / free.
+ */
+#define ARENA_MAX_BLOCK 1024UL
+
+/**
+ * @def ARENA_N_POOLS
+ * The number of pools of an arena, one per ARENA_ALIGN sized step.
+ */
+#define ARENA_N_POOLS (ARENA_MAX_BLOCK / ARENA_ALIGN)
+
+/**
+ * @struct arena_slab
+ * The header of a slab, its blocks follow it.
+ * @param next the next slab of the pool.
+ */
+typedef struct arena_slab {
+    struct arena_slab *next;
+    size_t pad; // keeps the blocks ARENA_ALIGN aligned
+} arena_slab;
+
+/**
+ * @struct slab_pool
+ * Hands out fixed size blocks, carved from large slabs. A returned block is
+ * kept on a free list for the next request, the slabs themselves are freed
+ * only by slab_pool_release.
+ * @param block_size the size of the blocks (a multiple of ARENA_ALIGN).
+ * @param free_list the returned blocks, each holding a pointer to the next.
+ * @param slabs the slabs taken so far.
+ * @param bump the first never used block of the newest slab.
+ * @param bump_left the number of never used blocks left in the newest slab.
+ */
+typedef struct slab_pool {
+    size_t block_size;
+    void *free_list;
+    arena_slab *slabs;
+    char *bump;
+    size_t bump_left;
+} slab_pool;
+
+/**
+ * @struct arena
+ * A set of slab pools, one per block size up to ARENA_MAX_BLOCK, serving
+ * allocations of any size.
+ * @param pools the pools, pools[i] serves blocks of (i + 1) * ARENA_ALIGN
+ * bytes.
+ * @param vector_allocator a vector allocator drawing from the arena.
+ */
+typedef struct arena {
+    slab_pool pools[ARENA_N_POOLS];
+    vector_allocator vector_allocator;
+} arena;
+
+/**
+ * Sets up an empty pool (nothing is allocated until the first block).
+ * @param pool the pool.
+ * @param block_size the size of the pool's blocks, rounded up to
+ * ARENA_ALIGN.
+ */
+void slab_pool_init (slab_pool *pool, size_t block_size);
+
+/**
+ * Takes a block from the pool.
+ * @param pool the pool.
+ * @return a block of pool->block_size bytes, NULL if failed.
+ */
+void *slab_pool_get (slab_pool *pool);
+
+/**
+ * Returns a block to the pool.
+ * @param pool the pool the block was taken from.
+ * @param block the block (NULL is ignored).
+ */
+void slab_pool_put (slab_pool *pool, void *block);
+
+/**
+ * Frees all the slabs of the pool at once (every block taken from it is
+ * invalid afterwards), leaving the pool empty and usable.
+ * @param pool the pool.
+ */
+void slab_pool_release (slab_pool *pool);
+
+/**
+ * Allocates dynamically new arena.
+ * @return pointer to dynamically allocated arena.
+ * @if_fail return NULL.
+ */
+arena *arena_alloc (void);
+
+/**
+ * Frees an arena and all its slabs (every block taken from it is invalid
+ * afterwards) - one free per slab.
+ * @param p_arena pointer to dynamically allocated pointer to arena.
+ */
+void arena_free (arena **p_arena);
+
+/**
+ * Takes size bytes from the arena.
+ * @param arena an arena.
+ * @param size the number of bytes.
+ * @return ARENA_ALIGN aligned memory, NULL if failed.
+ */
+void *arena_get (arena *arena, size_t size);
+
+/**
+ * Returns size bytes taken by arena_get to the arena.
+ * @param arena an arena.
+ * @param ptr the memory (NULL is ignored).
+ * @param size the size ptr was taken with.
+ */
+void arena_put (arena *arena, void *ptr, size_t size);
+
+#endif //ARENA_H_
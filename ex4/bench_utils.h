@@ -0,0 +1,35 @@
+#ifndef BENCH_UTILS_H_
+#define BENCH_UTILS_H_
+
+/*
+ * Small helpers shared by the benchmarks. The including file must define
+ * _POSIX_C_SOURCE (>= 199309L) before its first #include, for clock_gettime.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @return the current time of the monotonic clock, in nanoseconds.
+ */
+static inline double bench_now_ns (void)
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec * 1e9 + (double) now.tv_nsec;
+}
+
+/**
+ * A fast (xorshift64*) pseudo random generator, one state per thread.
+ * @param state pointer to the generator's state, must not start as 0.
+ * @return the next pseudo random number.
+ */
+static inline unsigned long long bench_rand (unsigned long long *state)
+{
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 2685821657736338717ULL;
+}
+
+#endif //BENCH_UTILS_H_
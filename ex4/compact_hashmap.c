@@ -0,0 +1,353 @@
+#include <string.h>
+#include "compact_hashmap.h"
+
+/**
+ * allocates an index of cap empty slots
+ * @return uint32_t* if successful, NULL otherwise.
+ */
+static uint32_t *index_alloc (size_t cap)
+{
+  uint32_t *index = (uint32_t *) malloc (sizeof (uint32_t) * cap);
+  if (index == NULL)
+    {
+      return NULL;
+    }
+  memset (index, 0xff, sizeof (uint32_t) * cap); // COMPACT_HASH_MAP_EMPTY
+  return index;
+}
+
+/**
+ * @return the number of entries (pairs and tombstones) an index of cap
+ * slots can refer to.
+ */
+static size_t index_limit (size_t cap)
+{
+  return (size_t) ((double) cap * COMPACT_HASH_MAP_MAX_LOAD_FACTOR);
+}
+
+/**
+ * puts an entry's position in the first empty slot of its probe sequence
+ */
+static void index_place (uint32_t *index, size_t cap, size_t hash,
+                         uint32_t pos)
+{
+  size_t mask = cap - 1;
+  size_t ind = hash & mask;
+  while (index[ind] != COMPACT_HASH_MAP_EMPTY)
+    {
+      ind = (ind + 1) & mask;
+    }
+  index[ind] = pos;
+}
+
+/**
+ * finds the entry of the given key. slots referring to tombstones do not
+ * stop the probing.
+ * @return the entry's position in the entries array if found, -1 otherwise
+ */
+static long entry_find (const compact_hashmap *hash_map, const_keyT key,
+                        size_t hash)
+{
+  size_t mask = hash_map->capacity - 1;
+  size_t ind = hash & mask;
+  const compact_entry *entry;
+  while (hash_map->index[ind] != COMPACT_HASH_MAP_EMPTY)
+    {
+      entry = &(hash_map->entries[hash_map->index[ind]]);
+      if (entry->hash == hash && entry->pair.key != NULL
+          && entry->pair.key_cmp (key, entry->pair.key) == 1)
+        {
+          return (long) hash_map->index[ind];
+        }
+      ind = (ind + 1) & mask;
+    }
+  return -1;
+}
+
+/**
+ * drops the tombstones of the entries array (keeping the order of the
+ * pairs) and rebuilds the index with new_cap slots, from the cached hashes.
+ * @param new_cap the new capacity, index_limit (new_cap) must exceed size.
+ * @return 0 if failed (the map is unchanged), 1 if successful
+ */
+static int compact_rebuild (compact_hashmap *hash_map, size_t new_cap)
+{
+  uint32_t *index = index_alloc (new_cap);
+  if (index == NULL)
+    {
+      return 0;
+    }
+  size_t pos = 0;
+  for (size_t i = 0; i < hash_map->used; ++i)
+    {
+      if (hash_map->entries[i].pair.key != NULL)
+        {
+          hash_map->entries[pos] = hash_map->entries[i];
+          index_place (index, new_cap, hash_map->entries[pos].hash,
+                       (uint32_t) pos);
+          ++pos;
+        }
+    }
+  free (hash_map->index);
+  hash_map->index = index;
+  hash_map->capacity = new_cap;
+  hash_map->used = pos;
+  // the entries array follows the index, failing to shrink it changes nothing
+  size_t entries_cap = index_limit (new_cap);
+  compact_entry *entries = (compact_entry *) realloc
+      (hash_map->entries, sizeof (compact_entry) * entries_cap);
+  if (entries != NULL)
+    {
+      hash_map->entries = entries;
+      hash_map->entries_cap = entries_cap;
+    }
+  return 1;
+}
+
+compact_hashmap *compact_hashmap_alloc (hash_func func)
+{
+  if (func == NULL)
+    {
+      return NULL;
+    }
+  compact_hashmap *new_hash = (compact_hashmap *)
+      malloc (sizeof (compact_hashmap));
+  if (new_hash == NULL)
+    {
+      return NULL;
+    }
+  new_hash->entries_cap = index_limit (COMPACT_HASH_MAP_INITIAL_CAP);
+  new_hash->index = index_alloc (COMPACT_HASH_MAP_INITIAL_CAP);
+  new_hash->entries = (compact_entry *) malloc (sizeof (compact_entry)
+                                                * new_hash->entries_cap);
+  if (new_hash->index == NULL || new_hash->entries == NULL)
+    {
+      free (new_hash->index);
+      free (new_hash->entries);
+      free (new_hash);
+      return NULL;
+    }
+  new_hash->capacity = COMPACT_HASH_MAP_INITIAL_CAP;
+  new_hash->used = 0;
+  new_hash->size = 0;
+  new_hash->hash_func = func;
+  return new_hash;
+}
+
+void compact_hashmap_free (compact_hashmap **p_hash_map)
+{
+  if (p_hash_map == NULL || *p_hash_map == NULL)
+    {
+      return;
+    }
+  compact_hashmap *hash_map = *p_hash_map;
+  for (size_t i = 0; i < hash_map->used; ++i)
+    {
+      if (hash_map->entries[i].pair.key != NULL)
+        {
+          hash_map->entries[i].pair.key_free (&(hash_map->entries[i].pair.key));
+          hash_map->entries[i].pair.value_free
+              (&(hash_map->entries[i].pair.value));
+        }
+    }
+  free (hash_map->index);
+  free (hash_map->entries);
+  free (hash_map);
+  *p_hash_map = NULL;
+}
+
+int compact_hashmap_insert (compact_hashmap *hash_map, const pair *in_pair)
+{
+  if (hash_map == NULL || in_pair == NULL)
+    {
+      return 0;
+    }
+  size_t hash = hash_map->hash_func (in_pair->key);
+  if (entry_find (hash_map, in_pair->key, hash) != -1
+      || hash_map->used >= COMPACT_HASH_MAP_EMPTY - 1)
+    {
+      return 0;
+    }
+  if (hash_map->used >= index_limit (hash_map->capacity))
+    {
+      // extend if the pairs alone would fill half of the limit again,
+      // otherwise dropping the tombstones makes enough room
+      size_t new_cap = hash_map->size >= index_limit (hash_map->capacity)
+                                         / COMPACT_HASH_MAP_GROWTH_FACTOR
+                       ? hash_map->capacity * COMPACT_HASH_MAP_GROWTH_FACTOR
+                       : hash_map->capacity;
+      if (compact_rebuild (hash_map, new_cap) == 0)
+        {
+          return 0;
+        }
+    }
+  if (hash_map->used == hash_map->entries_cap)
+    {
+      size_t entries_cap = hash_map->entries_cap
+                           * COMPACT_HASH_MAP_GROWTH_FACTOR;
+      compact_entry *entries = (compact_entry *) realloc
+          (hash_map->entries, sizeof (compact_entry) * entries_cap);
+      if (entries == NULL)
+        {
+          return 0;
+        }
+      hash_map->entries = entries;
+      hash_map->entries_cap = entries_cap;
+    }
+  compact_entry *entry = &(hash_map->entries[hash_map->used]);
+  entry->hash = hash;
+  entry->pair = *in_pair;
+  entry->pair.key = in_pair->key_cpy (in_pair->key);
+  if (entry->pair.key == NULL)
+    {
+      return 0;
+    }
+  entry->pair.value = in_pair->value_cpy (in_pair->value);
+  if (entry->pair.value == NULL)
+    {
+      entry->pair.key_free (&(entry->pair.key));
+      return 0;
+    }
+  index_place (hash_map->index, hash_map->capacity, hash,
+               (uint32_t) hash_map->used);
+  hash_map->used++;
+  hash_map->size++;
+  return 1;
+}
+
+valueT compact_hashmap_at (const compact_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return NULL;
+    }
+  long pos = entry_find (hash_map, key, hash_map->hash_func (key));
+  if (pos == -1)
+    {
+      return NULL;
+    }
+  return hash_map->entries[pos].pair.value;
+}
+
+int compact_hashmap_erase (compact_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return 0;
+    }
+  long pos = entry_find (hash_map, key, hash_map->hash_func (key));
+  if (pos == -1)
+    {
+      return 0;
+    }
+  // the index slot keeps referring to the tombstone until the next rebuild
+  compact_entry *entry = &(hash_map->entries[pos]);
+  entry->pair.key_free (&(entry->pair.key));
+  entry->pair.value_free (&(entry->pair.value));
+  entry->pair.key = NULL;
+  --hash_map->size;
+  // failed rebuilds leave a valid (just sparse) map behind
+  if (compact_hashmap_get_load_factor (hash_map)
+      < COMPACT_HASH_MAP_MIN_LOAD_FACTOR
+      && hash_map->capacity > COMPACT_HASH_MAP_MIN_CAP)
+    {
+      compact_rebuild (hash_map,
+                       hash_map->capacity / COMPACT_HASH_MAP_GROWTH_FACTOR);
+    }
+  else if (hash_map->used - hash_map->size > hash_map->used / 2)
+    {
+      compact_rebuild (hash_map, hash_map->capacity);
+    }
+  return 1;
+}
+
+double compact_hashmap_get_load_factor (const compact_hashmap *hash_map)
+{
+  if (hash_map == NULL || hash_map->capacity == 0)
+    {
+      return -1;
+    }
+  return (double) hash_map->size / hash_map->capacity;
+}
+
+int compact_hashmap_apply_if (const compact_hashmap *hash_map,
+                              keyT_func keyT_func, valueT_func valT_func)
+{
+  if (hash_map == NULL || keyT_func == NULL || valT_func == NULL)
+    {
+      return -1;
+    }
+  int count = 0;
+  for (size_t i = 0; i < hash_map->used; ++i)
+    {
+      if (hash_map->entries[i].pair.key != NULL
+          && keyT_func (hash_map->entries[i].pair.key) == 1)
+        {
+          valT_func (hash_map->entries[i].pair.value);
+          ++count;
+        }
+    }
+  return count;
+}
+
+/**
+ * moves an iterator to the first pair at (or after) its position
+ * @return 1 if the iterator is on a pair, 0 if the iteration ended
+ */
+static int iter_settle (compact_hashmap_iter *iter)
+{
+  const compact_hashmap *hash_map = iter->hash_map;
+  while (iter->pos < hash_map->used
+         && hash_map->entries[iter->pos].pair.key == NULL)
+    {
+      ++iter->pos;
+    }
+  return iter->pos < hash_map->used;
+}
+
+int compact_hashmap_iter_begin (const compact_hashmap *hash_map,
+                                compact_hashmap_iter *iter)
+{
+  if (iter == NULL)
+    {
+      return 0;
+    }
+  iter->hash_map = hash_map;
+  iter->pos = 0;
+  if (hash_map == NULL)
+    {
+      return 0;
+    }
+  return iter_settle (iter);
+}
+
+int compact_hashmap_iter_next (compact_hashmap_iter *iter)
+{
+  if (iter == NULL || iter->hash_map == NULL
+      || iter->pos >= iter->hash_map->used)
+    {
+      return 0;
+    }
+  ++iter->pos;
+  return iter_settle (iter);
+}
+
+const_keyT compact_hashmap_iter_key (const compact_hashmap_iter *iter)
+{
+  if (iter == NULL || iter->hash_map == NULL
+      || iter->pos >= iter->hash_map->used)
+    {
+      return NULL;
+    }
+  return iter->hash_map->entries[iter->pos].pair.key;
+}
+
+valueT compact_hashmap_iter_value (const compact_hashmap_iter *iter)
+{
+  if (iter == NULL || iter->hash_map == NULL
+      || iter->pos >= iter->hash_map->used)
+    {
+      return NULL;
+    }
+  return iter->hash_map->entries[iter->pos].pair.value;
+}
@@ -0,0 +1,192 @@
+#ifndef COMPACT_HASHMAP_H_
+#define COMPACT_HASHMAP_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "hashmap.h"
+#include "pair.h"
+
+/**
+ * @def COMPACT_HASH_MAP_INITIAL_CAP
+ * The initial capacity of the compact hash map.
+ * It means, the initial number of <b> index slots </b> the hash map has.
+ */
+#define COMPACT_HASH_MAP_INITIAL_CAP 16UL
+
+/**
+ * @def COMPACT_HASH_MAP_MIN_CAP
+ * The capacity the compact hash map never shrinks below.
+ */
+#define COMPACT_HASH_MAP_MIN_CAP 8UL
+
+/**
+ * @def COMPACT_HASH_MAP_GROWTH_FACTOR
+ * The growth factor of the compact hash map.
+ */
+#define COMPACT_HASH_MAP_GROWTH_FACTOR 2UL
+
+/**
+ * @def COMPACT_HASH_MAP_MIN_LOAD_FACTOR
+ * The minimal load factor the compact hash map can be in,
+ * after an erase that drops below it the map is minimized.
+ */
+#define COMPACT_HASH_MAP_MIN_LOAD_FACTOR 0.25
+
+/**
+ * @def COMPACT_HASH_MAP_MAX_LOAD_FACTOR
+ * The maximal share of the index slots in use (by pairs or by erased
+ * entries), an insertion at (or above) it compacts or extends the map first.
+ */
+#define COMPACT_HASH_MAP_MAX_LOAD_FACTOR 0.75
+
+/**
+ * @def COMPACT_HASH_MAP_EMPTY
+ * Marks an empty index slot.
+ */
+#define COMPACT_HASH_MAP_EMPTY UINT32_MAX
+
+/**
+ * @struct compact_entry
+ * An entry of the dense entries array.
+ * @param hash the result of hash_func on the pair's key.
+ * @param pair the pair, its key and value are copies owned by the map. An
+ * erased entry (a tombstone) has a NULL key.
+ */
+typedef struct compact_entry {
+    size_t hash;
+    pair pair;
+} compact_entry;
+
+/**
+ * @struct compact_hashmap
+ * A hash map keeping its pairs in a dense array in insertion order, found
+ * through a small open addressing (linear probing) table of indices into
+ * it. An erase leaves a tombstone in the entries array, and the tombstones
+ * are compacted away once they make half of it (or on resize).
+ * At most UINT32_MAX - 1 entries (pairs and tombstones) are held at once.
+ * @param index dynamic array of indices into entries, COMPACT_HASH_MAP_EMPTY
+ * marks an empty slot.
+ * @param capacity the number of index slots (a power of 2).
+ * @param entries dynamic array of the entries, in insertion order.
+ * @param used the number of entries (pairs and tombstones).
+ * @param entries_cap the number of entries the entries array can hold.
+ * @param size the number of elements (pairs) stored in the hash map.
+ * @param hash_func a function which "hashes" keys.
+ */
+typedef struct compact_hashmap {
+    uint32_t *index;
+    size_t capacity;
+    compact_entry *entries;
+    size_t used;
+    size_t entries_cap;
+    size_t size;
+    hash_func hash_func;
+} compact_hashmap;
+
+/**
+ * @struct compact_hashmap_iter
+ * A cursor over the pairs of a compact hash map, in insertion order. Any
+ * modification of the map invalidates it.
+ * @param hash_map the hash map iterated.
+ * @param pos the index of the current entry, hash_map->used once the
+ * iteration ended.
+ */
+typedef struct compact_hashmap_iter {
+    const compact_hashmap *hash_map;
+    size_t pos;
+} compact_hashmap_iter;
+
+/**
+ * Allocates dynamically new compact hash map element.
+ * @param func a function which "hashes" keys.
+ * @return pointer to dynamically allocated compact_hashmap.
+ * @if_fail return NULL.
+ */
+compact_hashmap *compact_hashmap_alloc (hash_func func);
+
+/**
+ * Frees a hash map and the elements the hash map itself allocated.
+ * @param p_hash_map pointer to dynamically allocated pointer to
+ * compact_hashmap.
+ */
+void compact_hashmap_free (compact_hashmap **p_hash_map);
+
+/**
+ * Inserts a copy of in_pair to the hash map (see hashmap_insert). The pair
+ * goes after all the pairs already in the map.
+ * @param hash_map the hash map to be inserted with new element.
+ * @param in_pair a in_pair the hash map would contain.
+ * @return returns 1 for successful insertion, 0 otherwise (also if the key
+ * is already in the map).
+ */
+int compact_hashmap_insert (compact_hashmap *hash_map, const pair *in_pair);
+
+/**
+ * The function returns the value associated with the given key.
+ * @param hash_map a hash map.
+ * @param key the key to be checked.
+ * @return the value associated with key if exists, NULL otherwise (the value
+ * itself, not a copy of it).
+ */
+valueT compact_hashmap_at (const compact_hashmap *hash_map, const_keyT key);
+
+/**
+ * The function erases the pair associated with key. The order of the other
+ * pairs is kept.
+ * @param hash_map a hash map.
+ * @param key a key of the pair to be erased.
+ * @return 1 if the erasing was done successfully, 0 otherwise. (if key not
+ * in map, considered fail).
+ */
+int compact_hashmap_erase (compact_hashmap *hash_map, const_keyT key);
+
+/**
+ * This function returns the load factor of the hash map.
+ * @param hash_map a hash map.
+ * @return the hash map's load factor, -1 if the function failed.
+ */
+double compact_hashmap_get_load_factor (const compact_hashmap *hash_map);
+
+/**
+ * Same as hashmap_apply_if, the pairs are visited in insertion order with a
+ * single sequential scan of the entries array.
+ * @param hash_map a hashmap
+ * @param keyT_func a function that checks a condition on keyT and return 1 if true, 0 else
+ * @param valT_func a function that modifies valueT, in-place
+ * @return number of changed values, -1 on bad input
+ */
+int compact_hashmap_apply_if (const compact_hashmap *hash_map,
+                              keyT_func keyT_func, valueT_func valT_func);
+
+/**
+ * Starts an iteration over the pairs of a hash map, in insertion order (see
+ * hashmap_iter_begin).
+ * @param hash_map a hash map, not to be modified during the iteration.
+ * @param iter the iterator to be set to the first pair.
+ * @return 1 if iter is on a pair, 0 if the map is empty (or on bad input).
+ */
+int compact_hashmap_iter_begin (const compact_hashmap *hash_map,
+                                compact_hashmap_iter *iter);
+
+/**
+ * Advances an iterator to the next pair.
+ * @param iter an iterator started by compact_hashmap_iter_begin.
+ * @return 1 if iter is on a pair, 0 if the iteration ended.
+ */
+int compact_hashmap_iter_next (compact_hashmap_iter *iter);
+
+/**
+ * @param iter an iterator.
+ * @return the key of the current pair (owned by the map, must not be
+ * modified), NULL if the iteration ended.
+ */
+const_keyT compact_hashmap_iter_key (const compact_hashmap_iter *iter);
+
+/**
+ * @param iter an iterator.
+ * @return the value of the current pair (owned by the map, may be modified
+ * in place), NULL if the iteration ended.
+ */
+valueT compact_hashmap_iter_value (const compact_hashmap_iter *iter);
+
+#endif //COMPACT_HASHMAP_H_
@@ -0,0 +1,170 @@
+#define _POSIX_C_SOURCE 200809L
+#include "concurrent_hashmap.h"
+
+/**
+ * @def SHARD_MIX
+ * 2^64 / golden ratio - multiplying by it spreads the hash's bits, so the
+ * shard (taken from the high bits) does not depend on the low bits the
+ * shard's own hash map uses for its buckets.
+ */
+#define SHARD_MIX 11400714819323198485ULL
+
+/**
+ * returns the shard the given key belongs to
+ */
+static hashmap_shard *shard_of (const concurrent_hashmap *hash_map,
+                                const_keyT key)
+{
+  if (hash_map->shard_bits == 0)
+    {
+      return hash_map->shards;
+    }
+  unsigned long long mixed =
+      (unsigned long long) hash_map->hash_func (key) * SHARD_MIX;
+  return &(hash_map->shards[mixed >> (64 - hash_map->shard_bits)]);
+}
+
+concurrent_hashmap *concurrent_hashmap_alloc (hash_func func, size_t n_shards)
+{
+  if (func == NULL)
+    {
+      return NULL;
+    }
+  if (n_shards == 0)
+    {
+      n_shards = CONCURRENT_HASHMAP_DEFAULT_SHARDS;
+    }
+  concurrent_hashmap *new_hash =
+      (concurrent_hashmap *) malloc (sizeof (concurrent_hashmap));
+  if (new_hash == NULL)
+    {
+      return NULL;
+    }
+  new_hash->shard_bits = 0;
+  while (((size_t) 1 << new_hash->shard_bits) < n_shards)
+    {
+      ++new_hash->shard_bits;
+    }
+  new_hash->n_shards = (size_t) 1 << new_hash->shard_bits;
+  new_hash->hash_func = func;
+  new_hash->shards = (hashmap_shard *) malloc (sizeof (hashmap_shard)
+                                               * new_hash->n_shards);
+  if (new_hash->shards == NULL)
+    {
+      free (new_hash);
+      return NULL;
+    }
+  for (size_t i = 0; i < new_hash->n_shards; ++i)
+    {
+      new_hash->shards[i].map = hashmap_alloc (func);
+      if (new_hash->shards[i].map == NULL
+          || pthread_rwlock_init (&(new_hash->shards[i].lock), NULL) != 0)
+        {
+          hashmap_free (&(new_hash->shards[i].map));
+          for (size_t j = 0; j < i; ++j)
+            {
+              pthread_rwlock_destroy (&(new_hash->shards[j].lock));
+              hashmap_free (&(new_hash->shards[j].map));
+            }
+          free (new_hash->shards);
+          free (new_hash);
+          return NULL;
+        }
+    }
+  return new_hash;
+}
+
+void concurrent_hashmap_free (concurrent_hashmap **p_hash_map)
+{
+  if (p_hash_map == NULL || *p_hash_map == NULL)
+    {
+      return;
+    }
+  for (size_t i = 0; i < (*p_hash_map)->n_shards; ++i)
+    {
+      pthread_rwlock_destroy (&((*p_hash_map)->shards[i].lock));
+      hashmap_free (&((*p_hash_map)->shards[i].map));
+    }
+  free ((*p_hash_map)->shards);
+  free (*p_hash_map);
+  *p_hash_map = NULL;
+}
+
+int concurrent_hashmap_insert (concurrent_hashmap *hash_map,
+                               const pair *in_pair)
+{
+  if (hash_map == NULL || in_pair == NULL)
+    {
+      return 0;
+    }
+  hashmap_shard *shard = shard_of (hash_map, in_pair->key);
+  pthread_rwlock_wrlock (&(shard->lock));
+  int result = hashmap_insert (shard->map, in_pair);
+  pthread_rwlock_unlock (&(shard->lock));
+  return result;
+}
+
+valueT concurrent_hashmap_at (concurrent_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return NULL;
+    }
+  hashmap_shard *shard = shard_of (hash_map, key);
+  valueT result = NULL;
+  pthread_rwlock_rdlock (&(shard->lock));
+  const pair *found = hashmap_find (shard->map, key);
+  if (found != NULL)
+    {
+      result = found->value_cpy (found->value);
+    }
+  pthread_rwlock_unlock (&(shard->lock));
+  return result;
+}
+
+int concurrent_hashmap_erase (concurrent_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return 0;
+    }
+  hashmap_shard *shard = shard_of (hash_map, key);
+  pthread_rwlock_wrlock (&(shard->lock));
+  int result = hashmap_erase (shard->map, key);
+  pthread_rwlock_unlock (&(shard->lock));
+  return result;
+}
+
+size_t concurrent_hashmap_size (concurrent_hashmap *hash_map)
+{
+  if (hash_map == NULL)
+    {
+      return 0;
+    }
+  size_t size = 0;
+  for (size_t i = 0; i < hash_map->n_shards; ++i)
+    {
+      pthread_rwlock_rdlock (&(hash_map->shards[i].lock));
+      size += hash_map->shards[i].map->size;
+      pthread_rwlock_unlock (&(hash_map->shards[i].lock));
+    }
+  return size;
+}
+
+int concurrent_hashmap_apply_if (concurrent_hashmap *hash_map,
+                                 keyT_func keyT_func, valueT_func valT_func)
+{
+  if (hash_map == NULL || keyT_func == NULL || valT_func == NULL)
+    {
+      return -1;
+    }
+  int count = 0;
+  for (size_t i = 0; i < hash_map->n_shards; ++i)
+    {
+      pthread_rwlock_wrlock (&(hash_map->shards[i].lock));
+      count += hashmap_apply_if (hash_map->shards[i].map,
+                                 keyT_func, valT_func);
+      pthread_rwlock_unlock (&(hash_map->shards[i].lock));
+    }
+  return count;
+}
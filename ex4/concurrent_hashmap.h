@@ -0,0 +1,112 @@
+#ifndef CONCURRENT_HASHMAP_H_
+#define CONCURRENT_HASHMAP_H_
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "hashmap.h"
+
+/**
+ * @def CONCURRENT_HASHMAP_DEFAULT_SHARDS
+ * The number of shards concurrent_hashmap_alloc uses if asked for 0.
+ */
+#define CONCURRENT_HASHMAP_DEFAULT_SHARDS 64UL
+
+/**
+ * @struct hashmap_shard
+ * A part of the concurrent hash map - an ordinary hash map guarded by its
+ * own reader/writer lock.
+ * @param lock the lock guarding map.
+ * @param map the hash map holding the pairs whose keys fall in the shard.
+ */
+typedef struct hashmap_shard {
+    pthread_rwlock_t lock;
+    hashmap *map;
+} hashmap_shard;
+
+/**
+ * @struct concurrent_hashmap
+ * A thread safe hash map: the keys are partitioned across independently
+ * locked shards, so threads working on different shards never wait for
+ * each other, and readers of the same shard run in parallel.
+ * @param shards dynamic array of the shards.
+ * @param n_shards the number of shards (a power of 2).
+ * @param shard_bits log2 of n_shards.
+ * @param hash_func a function which "hashes" keys.
+ */
+typedef struct concurrent_hashmap {
+    hashmap_shard *shards;
+    size_t n_shards;
+    size_t shard_bits;
+    hash_func hash_func;
+} concurrent_hashmap;
+
+/**
+ * Allocates dynamically new concurrent hash map element.
+ * @param func a function which "hashes" keys.
+ * @param n_shards the number of shards, rounded up to a power of 2
+ * (0 for CONCURRENT_HASHMAP_DEFAULT_SHARDS).
+ * @return pointer to dynamically allocated concurrent_hashmap.
+ * @if_fail return NULL.
+ */
+concurrent_hashmap *concurrent_hashmap_alloc (hash_func func, size_t n_shards);
+
+/**
+ * Frees a concurrent hash map and the elements the hash map itself allocated.
+ * Must not be called while other threads still use the map.
+ * @param p_hash_map pointer to dynamically allocated pointer to
+ * concurrent_hashmap.
+ */
+void concurrent_hashmap_free (concurrent_hashmap **p_hash_map);
+
+/**
+ * Inserts a copy of in_pair to the hash map (see hashmap_insert).
+ * @param hash_map the hash map to be inserted with new element.
+ * @param in_pair a in_pair the hash map would contain.
+ * @return returns 1 for successful insertion, 0 otherwise.
+ */
+int concurrent_hashmap_insert (concurrent_hashmap *hash_map,
+                               const pair *in_pair);
+
+/**
+ * The function returns a copy of the value associated with the given key.
+ * Unlike hashmap_at, a copy is returned: another thread may erase the pair
+ * as soon as the shard's lock is released.
+ * @param hash_map a hash map.
+ * @param key the key to be checked.
+ * @return dynamically allocated copy of the value associated with key (made
+ * by the pair's value copy function, to be freed by the caller), NULL if the
+ * key is not in the map or the function failed.
+ */
+valueT concurrent_hashmap_at (concurrent_hashmap *hash_map, const_keyT key);
+
+/**
+ * The function erases the pair associated with key.
+ * @param hash_map a hash map.
+ * @param key a key of the pair to be erased.
+ * @return 1 if the erasing was done successfully, 0 otherwise. (if key not in
+ * map, considered fail).
+ */
+int concurrent_hashmap_erase (concurrent_hashmap *hash_map, const_keyT key);
+
+/**
+ * Returns the number of pairs in the hash map. The shards are counted one
+ * after the other, so under concurrent writes the result is approximate.
+ * @param hash_map a hash map.
+ * @return number of pairs.
+ */
+size_t concurrent_hashmap_size (concurrent_hashmap *hash_map);
+
+/**
+ * Applies valT_func on the values whose keys fulfill keyT_func
+ * (see hashmap_apply_if). Every shard is write locked while it is visited,
+ * so each value is modified atomically with respect to the other operations.
+ * @param hash_map a hash map.
+ * @param keyT_func a function that checks a condition on keyT and return 1
+ * if true, 0 else.
+ * @param valT_func a function that modifies valueT, in-place.
+ * @return number of changed values, -1 on bad input.
+ */
+int concurrent_hashmap_apply_if (concurrent_hashmap *hash_map,
+                                 keyT_func keyT_func, valueT_func valT_func);
+
+#endif //CONCURRENT_HASHMAP_H_
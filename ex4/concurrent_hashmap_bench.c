@@ -0,0 +1,194 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <unistd.h>
+#include "concurrent_hashmap.h"
+#include "test_pairs.h"
+#include "hash_funcs.h"
+#include "bench_utils.h"
+
+/*
+ * Measures the throughput of concurrent_hashmap against an ordinary hashmap
+ * guarded by one global mutex, from 1 thread up to all the online cores.
+ * usage: concurrent_hashmap_bench [ops_per_thread]
+ */
+
+#define BENCH_KEYS 65536
+#define BENCH_DEFAULT_OPS 1000000UL
+#define BENCH_WRITE_PERCENT 10 // half inserts, half erases
+#define BENCH_MAX_THREADS 1024
+
+static concurrent_hashmap *sharded_map;
+static hashmap *global_map;
+static pthread_mutex_t global_lock = PTHREAD_MUTEX_INITIALIZER;
+static pair *bench_pairs[BENCH_KEYS];
+
+typedef struct bench_args {
+    unsigned long long seed;
+    size_t ops;
+    int use_global;
+} bench_args;
+
+static void *bench_worker (void *arg)
+{
+  bench_args *args = (bench_args *) arg;
+  unsigned long long state = args->seed;
+  valueT value;
+  for (size_t i = 0; i < args->ops; ++i)
+    {
+      unsigned long long r = bench_rand (&state);
+      int key_ind = (int) (r % BENCH_KEYS);
+      int op = (int) ((r >> 32) % 100);
+      const pair *in_pair = bench_pairs[key_ind];
+      if (args->use_global)
+        {
+          pthread_mutex_lock (&global_lock);
+          if (op < BENCH_WRITE_PERCENT / 2)
+            {
+              hashmap_erase (global_map, in_pair->key);
+            }
+          else if (op < BENCH_WRITE_PERCENT)
+            {
+              hashmap_insert (global_map, in_pair);
+            }
+          else
+            {
+              // copy like concurrent_hashmap_at, for a fair comparison
+              value = hashmap_at (global_map, in_pair->key);
+              value = value == NULL ? NULL : int_value_cpy (value);
+              int_value_free (&value);
+            }
+          pthread_mutex_unlock (&global_lock);
+        }
+      else
+        {
+          if (op < BENCH_WRITE_PERCENT / 2)
+            {
+              concurrent_hashmap_erase (sharded_map, in_pair->key);
+            }
+          else if (op < BENCH_WRITE_PERCENT)
+            {
+              concurrent_hashmap_insert (sharded_map, in_pair);
+            }
+          else
+            {
+              value = concurrent_hashmap_at (sharded_map, in_pair->key);
+              int_value_free (&value);
+            }
+        }
+    }
+  return NULL;
+}
+
+/**
+ * runs n_threads workers on one of the maps
+ * @return the throughput, in millions of operations per second, -1 if a
+ * worker could not be started (the started ones are still joined)
+ */
+static double bench_run (int n_threads, size_t ops, int use_global)
+{
+  pthread_t threads[BENCH_MAX_THREADS];
+  bench_args args[BENCH_MAX_THREADS];
+  int started = 0;
+  double start = bench_now_ns ();
+  for (; started < n_threads; ++started)
+    {
+      args[started].seed = 0x9E3779B97F4A7C15ULL
+                           * (unsigned long long) (started + 1);
+      args[started].ops = ops;
+      args[started].use_global = use_global;
+      if (pthread_create (&threads[started], NULL, bench_worker,
+                          &args[started]) != 0)
+        {
+          break;
+        }
+    }
+  for (int i = 0; i < started; ++i)
+    {
+      pthread_join (threads[i], NULL);
+    }
+  if (started != n_threads)
+    {
+      return -1;
+    }
+  double elapsed = bench_now_ns () - start;
+  return (double) ops * n_threads / elapsed * 1e3;
+}
+
+/**
+ * frees the maps and the pairs allocated so far (any of them may be NULL)
+ * @return result, so that main can return through it
+ */
+static int bench_cleanup (int result)
+{
+  for (int i = 0; i < BENCH_KEYS; ++i)
+    {
+      if (bench_pairs[i] != NULL)
+        {
+          void *temp = bench_pairs[i];
+          pair_free (&temp);
+          bench_pairs[i] = NULL;
+        }
+    }
+  concurrent_hashmap_free (&sharded_map);
+  hashmap_free (&global_map);
+  return result;
+}
+
+int main (int argc, char *argv[])
+{
+  size_t ops = argc > 1 ? strtoul (argv[1], NULL, 10) : BENCH_DEFAULT_OPS;
+  long n_cores = sysconf (_SC_NPROCESSORS_ONLN);
+  if (n_cores < 1)
+    {
+      n_cores = 1;
+    }
+  if (n_cores > BENCH_MAX_THREADS)
+    {
+      n_cores = BENCH_MAX_THREADS;
+    }
+  sharded_map = concurrent_hashmap_alloc (hash_int, 0);
+  global_map = hashmap_alloc (hash_int);
+  if (sharded_map == NULL || global_map == NULL)
+    {
+      return bench_cleanup (EXIT_FAILURE);
+    }
+  for (int i = 0; i < BENCH_KEYS; ++i)
+    {
+      bench_pairs[i] = pair_alloc (&i, &i, int_value_cpy, int_value_cpy,
+                                   int_value_cmp, int_value_cmp,
+                                   int_value_free, int_value_free);
+      if (bench_pairs[i] == NULL)
+        {
+          return bench_cleanup (EXIT_FAILURE);
+        }
+      if (i % 2 == 0) // start half full
+        {
+          concurrent_hashmap_insert (sharded_map, bench_pairs[i]);
+          hashmap_insert (global_map, bench_pairs[i]);
+        }
+    }
+  printf ("%d keys, %lu ops per thread, %d%% writes\n", BENCH_KEYS,
+          (unsigned long) ops, BENCH_WRITE_PERCENT);
+  printf ("%8s %16s %16s %9s\n", "threads", "sharded Mops/s",
+          "global Mops/s", "speedup");
+  int n_threads = 1, result = EXIT_SUCCESS;
+  while (1) // 1, 2, 4, ..., n_cores
+    {
+      double sharded = bench_run (n_threads, ops, 0);
+      double global = sharded < 0 ? -1 : bench_run (n_threads, ops, 1);
+      if (global < 0)
+        {
+          fprintf (stderr, "could not start %d threads\n", n_threads);
+          result = EXIT_FAILURE;
+          break;
+        }
+      printf ("%8d %16.2f %16.2f %8.2fx\n", n_threads, sharded, global,
+              sharded / global);
+      if (n_threads == n_cores)
+        {
+          break;
+        }
+      n_threads = n_threads * 2 > n_cores ? (int) n_cores : n_threads * 2;
+    }
+  return bench_cleanup (result);
+}
@@ -19,4 +19,48 @@ size_t hash_char(const void *elem){
   return hash;
 }
 
+/**
+ * The 64 bit finalizer of MurmurHash3 - every bit of x affects every bit of
+ * the result, so keys differing only in their high bits do not collide in
+ * the low bits a hash map keeps.
+ */
+static inline size_t hash_mix64 (unsigned long long x)
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return (size_t) x;
+}
+
+/**
+ * Integers mixing hash func.
+ */
+size_t hash_int_mix(const void *elem){
+  return hash_mix64 ((unsigned int) *((int *) elem));
+}
+
+/**
+ * Chars mixing hash func.
+ */
+size_t hash_char_mix(const void *elem){
+  return hash_mix64 ((unsigned char) *((char *) elem));
+}
+
+/**
+ * Null terminated strings hash func: 64 bit FNV-1a, finalized by hash_mix64
+ * (the low bits of FNV depend only on the low bits of the characters).
+ */
+size_t hash_string(const void *elem){
+  const unsigned char *str = (const unsigned char *) elem;
+  unsigned long long hash = 0xcbf29ce484222325ULL;
+  while (*str != '\0')
+    {
+      hash ^= *str++;
+      hash *= 0x100000001b3ULL;
+    }
+  return hash_mix64 (hash);
+}
+
 #endif // HASHFUNCS_H_
\ No newline at end of file
@@ -0,0 +1,176 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include "hash_funcs.h"
+#include "hashmap.h"
+#include "bench_utils.h"
+
+/*
+ * Measures how well the hash funcs of hash_funcs.h spread keys over a
+ * hashmap's buckets (capacity a power of 2, the index keeps the low bits):
+ * the longest chain and the average number of pairs a successful lookup
+ * compares, on adversarial, sequential and random integers, all the chars
+ * and the distinct words of a text file.
+ * usage: hash_funcs_bench [words_file]
+ */
+
+#define BENCH_KEYS 65536
+#define BENCH_MAX_WORD 256
+
+/**
+ * hashes every key into a table the size a hashmap holding n keys would
+ * have, and prints the chains' statistics
+ * @param keys n pointers to keys
+ */
+static void bench_hash (const char *set_name, const char *func_name,
+                        hash_func func, const void *const *keys, size_t n)
+{
+  size_t cap = HASH_MAP_INITIAL_CAP;
+  while ((double) n / cap > HASH_MAP_MAX_LOAD_FACTOR)
+    {
+      cap *= HASH_MAP_GROWTH_FACTOR;
+    }
+  size_t *chains = (size_t *) calloc (cap, sizeof (size_t));
+  if (chains == NULL)
+    {
+      return;
+    }
+  double start = bench_now_ns ();
+  for (size_t i = 0; i < n; ++i)
+    {
+      ++chains[func (keys[i]) & (cap - 1)];
+    }
+  double elapsed = bench_now_ns () - start;
+  size_t max_chain = 0;
+  size_t probes = 0; // the k-th pair of a chain is found after k compares
+  for (size_t i = 0; i < cap; ++i)
+    {
+      max_chain = chains[i] > max_chain ? chains[i] : max_chain;
+      probes += chains[i] * (chains[i] + 1) / 2;
+    }
+  printf ("%-12s %-14s %8lu %8lu %10lu %12.2f %9.2f\n", set_name, func_name,
+          (unsigned long) n, (unsigned long) cap, (unsigned long) max_chain,
+          (double) probes / n, elapsed / n);
+  free (chains);
+}
+
+/**
+ * qsort comparison of two strings, given pointers to them
+ */
+static int cmp_words (const void *word_1, const void *word_2)
+{
+  return strcmp (*(char *const *) word_1, *(char *const *) word_2);
+}
+
+/**
+ * reads the distinct whitespace separated words of a file
+ * @param p_words set to a dynamically allocated array of the words
+ * @return the number of words, 0 if failed
+ */
+static size_t read_words (const char *path, char ***p_words)
+{
+  FILE *file = fopen (path, "r");
+  if (file == NULL)
+    {
+      return 0;
+    }
+  size_t n = 0, cap = 1024;
+  char **words = (char **) malloc (cap * sizeof (char *));
+  char word[BENCH_MAX_WORD];
+  while (words != NULL && fscanf (file, "%255s", word) == 1)
+    {
+      if (n == cap)
+        {
+          char **temp = (char **) realloc (words, 2 * cap * sizeof (char *));
+          if (temp == NULL)
+            {
+              break;
+            }
+          words = temp;
+          cap *= 2;
+        }
+      words[n] = (char *) malloc (strlen (word) + 1);
+      if (words[n] == NULL)
+        {
+          break;
+        }
+      strcpy (words[n++], word);
+    }
+  fclose (file);
+  if (words == NULL)
+    {
+      return 0;
+    }
+  qsort (words, n, sizeof (char *), cmp_words);
+  size_t distinct = 0;
+  for (size_t i = 0; i < n; ++i)
+    {
+      if (distinct > 0 && strcmp (words[distinct - 1], words[i]) == 0)
+        {
+          free (words[i]);
+        }
+      else
+        {
+          words[distinct++] = words[i];
+        }
+    }
+  *p_words = words;
+  return distinct;
+}
+
+int main (int argc, char *argv[])
+{
+  static int ints[BENCH_KEYS];
+  static char chars[256];
+  static const void *keys[BENCH_KEYS];
+  printf ("%-12s %-14s %8s %8s %10s %12s %9s\n", "keys", "hash", "n", "cap",
+          "max chain", "avg probes", "ns/hash");
+  for (int i = 0; i < BENCH_KEYS; ++i)
+    {
+      keys[i] = &ints[i];
+      ints[i] = i * 1024;
+    }
+  bench_hash ("x * 1024", "hash_int", hash_int, keys, BENCH_KEYS);
+  bench_hash ("x * 1024", "hash_int_mix", hash_int_mix, keys, BENCH_KEYS);
+  for (int i = 0; i < BENCH_KEYS; ++i)
+    {
+      ints[i] = i;
+    }
+  bench_hash ("sequential", "hash_int", hash_int, keys, BENCH_KEYS);
+  bench_hash ("sequential", "hash_int_mix", hash_int_mix, keys, BENCH_KEYS);
+  unsigned long long state = 0x9E3779B97F4A7C15ULL;
+  for (int i = 0; i < BENCH_KEYS; ++i)
+    {
+      ints[i] = (int) bench_rand (&state);
+    }
+  bench_hash ("random", "hash_int", hash_int, keys, BENCH_KEYS);
+  bench_hash ("random", "hash_int_mix", hash_int_mix, keys, BENCH_KEYS);
+  for (int i = 0; i < 256; ++i)
+    {
+      chars[i] = (char) i;
+      keys[i] = &chars[i];
+    }
+  bench_hash ("chars", "hash_char", hash_char, keys, 256);
+  bench_hash ("chars", "hash_char_mix", hash_char_mix, keys, 256);
+  if (argc > 1)
+    {
+      char **words;
+      size_t n = read_words (argv[1], &words);
+      if (n == 0)
+        {
+          fprintf (stderr, "could not read words from %s\n", argv[1]);
+          return EXIT_FAILURE;
+        }
+      // hash_char on a string hashes its first char only
+      bench_hash ("words", "hash_char", hash_char, (const void *const *) words,
+                  n);
+      bench_hash ("words", "hash_string", hash_string,
+                  (const void *const *) words, n);
+      for (size_t i = 0; i < n; ++i)
+        {
+          free (words[i]);
+        }
+      free (words);
+    }
+  return EXIT_SUCCESS;
+}
@@ -1,51 +1,423 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
 #include "hashmap.h"
 #define HASH_MAP_MIN_SIZE 1
+
+#ifdef __GNUC__
+#define HASH_MAP_PREFETCH(addr) __builtin_prefetch (addr)
+#else
+#define HASH_MAP_PREFETCH(addr) ((void) (addr))
+#endif
+
+#ifdef HASHMAP_STATS
+#include <string.h>
+#include <time.h>
+
+/**
+ * @struct hashmap_counters
+ * The counters behind hashmap_stats. They are allocated apart from the map,
+ * so that const operations (hashmap_at) can update them. The lookup
+ * counters are updated atomically, since lookups may run concurrently.
+ */
+struct hashmap_counters {
+    size_t rehash_count;
+    double rehash_ns;
+    size_t lookups;
+    size_t lookup_probes;
+};
+
+/**
+ * @return the current time of the monotonic clock, in nanoseconds.
+ */
+double stats_now_ns (void)
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec * 1e9 + (double) now.tv_nsec;
+}
+#endif
 /**
- * allocates memory for a vector** and allocates vectors inside each ptr,
- * in size of HASH_MAP_INITIAL_CAP
- * @param ptr - given ptr to allocate memory in
- * @return vector** if successful, NULL otherwise.
+ * allocates a new entry holding copies of the key and the value of in_pair
+ * @param arena the arena to take the entry from, NULL for malloc
+ * @param in_pair the pair to be copied
+ * @param hash the result of hash_func on in_pair's key
+ * @return hashmap_entry* if successful, NULL otherwise.
  */
-vector **buckets_alloc (int cap)
+hashmap_entry *entry_alloc (arena *arena, const pair *in_pair, size_t hash)
 {
-  vector **ptr = (vector **) malloc (sizeof (vector * ) * cap);
-  if (ptr == NULL)
+  hashmap_entry *new_entry = (hashmap_entry *)
+      (arena == NULL ? malloc (sizeof (hashmap_entry))
+                     : arena_get (arena, sizeof (hashmap_entry)));
+  if (new_entry == NULL)
     {
       return NULL;
     }
-  for (int i = 0; i < cap; ++i)
+  new_entry->hash = hash;
+  new_entry->pair = *in_pair;
+  new_entry->pair.key = in_pair->key_cpy (in_pair->key);
+  if (new_entry->pair.key != NULL)
     {
-      ptr[i] = vector_alloc (pair_copy, pair_cmp, pair_free);
-      if (ptr[i] == NULL)
+      new_entry->pair.value = in_pair->value_cpy (in_pair->value);
+      if (new_entry->pair.value != NULL)
         {
-          for (int j = 0; j < i; ++j)
-            {
-              vector_free (&(ptr[j]));
-            }
-          free (ptr);
-          return NULL;
+          return new_entry;
         }
+      new_entry->pair.key_free (&(new_entry->pair.key));
+    }
+  if (arena == NULL)
+    {
+      free (new_entry);
+    }
+  else
+    {
+      arena_put (arena, new_entry, sizeof (hashmap_entry));
+    }
+  return NULL;
+}
+
+/**
+ * copies an entry (vector_elem_cpy of the buckets' overflow vectors)
+ */
+void *entry_copy (const void *to_copy)
+{
+  const hashmap_entry *temp = (const hashmap_entry *) to_copy;
+  return entry_alloc (NULL, &(temp->pair), temp->hash);
+}
+
+/**
+ * compares two entries (vector_elem_cmp of the buckets' overflow vectors)
+ */
+int entry_cmp (const void *entry_1, const void *entry_2)
+{
+  const hashmap_entry *temp_1 = (const hashmap_entry *) entry_1;
+  const hashmap_entry *temp_2 = (const hashmap_entry *) entry_2;
+  return temp_1->hash == temp_2->hash
+         && pair_cmp (&(temp_1->pair), &(temp_2->pair)) == 1;
+}
+
+/**
+ * frees an entry (vector_elem_free of the buckets' overflow vectors)
+ */
+void entry_free (void **p_entry)
+{
+  if (p_entry == NULL || *p_entry == NULL)
+    {
+      return;
+    }
+  hashmap_entry *temp = (hashmap_entry *) *p_entry;
+  temp->pair.key_free (&(temp->pair.key));
+  temp->pair.value_free (&(temp->pair.value));
+  free (temp);
+  *p_entry = NULL;
+}
+
+/**
+ * frees an entry allocated by entry_alloc with the same arena
+ */
+void entry_release (arena *arena, hashmap_entry *entry)
+{
+  if (arena == NULL)
+    {
+      void *p_temp = entry;
+      entry_free (&p_temp);
+      return;
     }
-  return ptr;
+  entry->pair.key_free (&(entry->pair.key));
+  entry->pair.value_free (&(entry->pair.value));
+  arena_put (arena, entry, sizeof (hashmap_entry));
+}
+
+/**
+ * allocates memory for an array of cap empty buckets. the buckets themselves
+ * allocate nothing until an entry is pushed into them.
+ * @param cap - number of buckets
+ * @return bucket* if successful, NULL otherwise.
+ */
+bucket *buckets_alloc (size_t cap)
+{
+  return (bucket *) calloc (cap, sizeof (bucket));
 }
 
-void buckets_free (vector ***ptr, int cap)
+void buckets_free (arena *arena, bucket **ptr, size_t cap)
 {
-  for (int i = 0; i < cap; ++i)
+  bucket *buck;
+  for (size_t i = 0; i < cap; ++i)
     {
-      vector_free (&((*ptr)[i]));
+      buck = &((*ptr)[i]);
+      if (buck->head == NULL)
+        {
+          continue;
+        }
+      entry_release (arena, buck->head);
+      while (buck->rest != NULL && buck->rest->size > 0)
+        {
+          entry_release (arena, vector_detach_back (buck->rest));
+        }
+      vector_free (&(buck->rest));
     }
   free (*ptr);
-  ptr = NULL;
+  *ptr = NULL;
 }
 
-int complete_hash_func (size_t hash_func_res, int cap)
+size_t complete_hash_func (size_t hash_func_res, size_t cap)
 {
-  int index;
   size_t altered_cap = cap - 1;
-  size_t s_index = hash_func_res & altered_cap;
-  index = (int) s_index;
-  return index;
+  return hash_func_res & altered_cap;
+}
+
+/**
+ * adds an entry to a bucket without copying it - the bucket takes ownership.
+ * the overflow vector is allocated only when a second entry arrives.
+ * @param arena the arena of the map, NULL if it has none
+ * @param buck a bucket
+ * @param in_entry a dynamically allocated entry
+ * @return 0 if failed (in_entry is still owned by the caller), 1 if successful
+ */
+int bucket_push_owned (arena *arena, bucket *buck, hashmap_entry *in_entry)
+{
+  if (buck->head == NULL)
+    {
+      buck->head = in_entry;
+      return 1;
+    }
+  if (buck->rest == NULL)
+    {
+      buck->rest = vector_alloc_with_allocator
+          (entry_copy, entry_cmp, entry_free,
+           arena == NULL ? NULL : &(arena->vector_allocator));
+      if (buck->rest == NULL)
+        {
+          return 0;
+        }
+    }
+  return vector_push_back_owned (buck->rest, in_entry);
+}
+
+/**
+ * checks whether an entry holds the given key, key_cmp is called only if
+ * the cached hash matches
+ */
+int entry_has_key (const hashmap_entry *temp, const_keyT key, size_t hash)
+{
+  return temp->hash == hash && temp->pair.key_cmp (key, temp->pair.key) == 1;
+}
+
+/**
+ * finds the entry with the given key in a bucket
+ * @param buck a bucket
+ * @param key the key to look for
+ * @param hash the result of hash_func on key
+ * @return pointer to the bucket's slot holding the entry (&head or an element
+ * of rest), NULL if the key is not in the bucket
+ */
+hashmap_entry **bucket_find (const bucket *buck, const_keyT key, size_t hash)
+{
+  if (buck->head == NULL)
+    {
+      return NULL;
+    }
+  if (entry_has_key (buck->head, key, hash))
+    {
+      return (hashmap_entry **) &(buck->head);
+    }
+  if (buck->rest == NULL)
+    {
+      return NULL;
+    }
+  for (size_t i = 0; i < buck->rest->size; ++i)
+    {
+      if (entry_has_key (buck->rest->data[i], key, hash))
+        {
+          return (hashmap_entry **) &(buck->rest->data[i]);
+        }
+    }
+  return NULL;
+}
+
+/**
+ * frees the entry in the given slot of a bucket and closes the gap - the
+ * last entry of rest takes the erased entry's place (the order of a bucket
+ * does not matter). the map frees the entries itself, never the vector, so
+ * that they go back to the map's arena.
+ * @param arena the arena of the map, NULL if it has none
+ * @param buck a bucket
+ * @param slot a slot of the bucket, as returned by bucket_find
+ * @return 0 if failed, 1 if successful
+ */
+int bucket_erase (arena *arena, bucket *buck, hashmap_entry **slot)
+{
+  hashmap_entry *erased = *slot;
+  hashmap_entry *last = vector_detach_back (buck->rest);
+  if (last != NULL && (void **) slot != &(buck->rest->data[buck->rest->size]))
+    {
+      *slot = last;
+    }
+  else if (slot == &(buck->head))
+    {
+      buck->head = NULL;
+    }
+  entry_release (arena, erased);
+  if (buck->rest != NULL && buck->rest->size == 0)
+    {
+      vector_free (&(buck->rest));
+    }
+  return 1;
+}
+
+/**
+ * finds the bucket holding the given key, looking in the old bucket array
+ * too while a resize is in progress
+ * @param hash_map hash table
+ * @param key the key to look for
+ * @param hash the result of hash_func on key
+ * @param p_bucket out - the bucket holding the key (or the bucket it would be
+ * inserted to, if not in the map)
+ * @return pointer to the bucket's slot holding the entry, NULL if the key is
+ * not in the map
+ */
+hashmap_entry **hashmap_locate (const hashmap *hash_map, const_keyT key,
+                                size_t hash, bucket **p_bucket)
+{
+  hashmap_entry **slot;
+  if (hash_map->old_buckets != NULL)
+    {
+      *p_bucket = &(hash_map->old_buckets
+      [complete_hash_func (hash, hash_map->old_capacity)]);
+      slot = bucket_find (*p_bucket, key, hash);
+      if (slot != NULL)
+        {
+          return slot;
+        }
+    }
+  *p_bucket = &(hash_map->buckets
+  [complete_hash_func (hash, hash_map->capacity)]);
+  return bucket_find (*p_bucket, key, hash);
+}
+
+/**
+ * moves a single entry to its bucket in the new bucket array, using the
+ * cached hash (hash_func is not called)
+ * @return 0 if failed, 1 if successful
+ */
+int migrate_entry (hashmap *hash, hashmap_entry *in_entry)
+{
+  size_t hash_res = complete_hash_func (in_entry->hash, hash->capacity);
+  return bucket_push_owned (hash->arena, &(hash->buckets[hash_res]),
+                            in_entry);
+}
+
+/**
+ * migrates up to max_buckets old buckets to the new bucket array.
+ * the entries are moved (their pointers are relinked, nothing is copied) one
+ * by one, so a failure leaves every entry in exactly one of the arrays and
+ * the migration can simply be resumed later.
+ * @param hash hash table
+ * @param max_buckets maximal number of old buckets to migrate
+ * @return 0 if failed, 1 if successful
+ */
+int migrate_buckets (hashmap *hash, size_t max_buckets)
+{
+  bucket *buck;
+  for (size_t count = 0; hash->old_buckets != NULL && count < max_buckets;
+       ++count)
+    {
+      buck = &(hash->old_buckets[hash->migrate_index]);
+      while (buck->rest != NULL && buck->rest->size > 0)
+        {
+          if (migrate_entry (hash, buck->rest->data[buck->rest->size - 1])
+              == 0)
+            {
+              return 0;
+            }
+          vector_detach_back (buck->rest);
+        }
+      vector_free (&(buck->rest));
+      if (buck->head != NULL)
+        {
+          if (migrate_entry (hash, buck->head) == 0)
+            {
+              return 0;
+            }
+          buck->head = NULL;
+        }
+      if (++hash->migrate_index == hash->old_capacity)
+        {
+          free (hash->old_buckets);
+          hash->old_buckets = NULL;
+          hash->old_capacity = 0;
+          hash->migrate_index = 0;
+        }
+    }
+  return 1;
+}
+
+/**
+ * re-organizes the hash-table after a change of size: allocates the new
+ * bucket array and migrates the pairs to it - all at once, or only the
+ * first HASH_MAP_MIGRATE_STEP buckets if the map is incremental.
+ * a resize still in progress is completed first.
+ * @param hash hash table
+ * @param new_cap the new number of buckets
+ * @return 0 if failed, 1 if successful
+ */
+int reorganize_buckets (hashmap *hash, size_t new_cap)
+{
+  if (migrate_buckets (hash, hash->old_capacity) == 0)
+    {
+      return 0;
+    }
+  bucket *temp = buckets_alloc (new_cap);
+  if (temp == NULL)
+    {
+      return 0;
+    }
+  hash->old_buckets = hash->buckets;
+  hash->old_capacity = hash->capacity;
+  hash->migrate_index = 0;
+  hash->buckets = temp;
+  hash->capacity = new_cap;
+  return migrate_buckets (hash, hash->incremental ? HASH_MAP_MIGRATE_STEP
+                                                  : hash->old_capacity);
+}
+
+/**
+ * re-organizes the hash-table after a change of size (reorganize_buckets),
+ * counted in the statistics when they are compiled in
+ * @param hash hash table
+ * @param new_cap the new number of buckets
+ * @return 0 if failed, 1 if successful
+ */
+int reorganize_hash (hashmap *hash, size_t new_cap)
+{
+#ifdef HASHMAP_STATS
+  double start = stats_now_ns ();
+  int result = reorganize_buckets (hash, new_cap);
+  hash->stats->rehash_ns += stats_now_ns () - start;
+  hash->stats->rehash_count += (size_t) result;
+  return result;
+#else
+  return reorganize_buckets (hash, new_cap);
+#endif
+}
+
+/**
+ * migrates the next HASH_MAP_MIGRATE_STEP old buckets, if a resize is in
+ * progress. a failed step is simply retried by the next operation.
+ * @param hash hash table
+ */
+void migrate_step (hashmap *hash)
+{
+  if (hash->old_buckets == NULL)
+    {
+      return;
+    }
+#ifdef HASHMAP_STATS
+  double start = stats_now_ns ();
+  migrate_buckets (hash, HASH_MAP_MIGRATE_STEP);
+  hash->stats->rehash_ns += stats_now_ns () - start;
+#else
+  migrate_buckets (hash, HASH_MAP_MIGRATE_STEP);
+#endif
 }
 
 hashmap *hashmap_alloc (hash_func func)
@@ -61,202 +433,496 @@ hashmap *hashmap_alloc (hash_func func)
       free (new_hash);
       return NULL;
     }
+#ifdef HASHMAP_STATS
+  new_hash->stats = (struct hashmap_counters *)
+      calloc (1, sizeof (struct hashmap_counters));
+  if (new_hash->stats == NULL)
+    {
+      free (new_hash->buckets);
+      free (new_hash);
+      return NULL;
+    }
+#endif
   new_hash->hash_func = func;
   new_hash->capacity = HASH_MAP_INITIAL_CAP;
   new_hash->size = 0;
+  new_hash->incremental = 0;
+  new_hash->old_buckets = NULL;
+  new_hash->old_capacity = 0;
+  new_hash->migrate_index = 0;
+  new_hash->arena = NULL;
+  new_hash->policy = hashmap_default_resize_policy ();
+  new_hash->low_load_erases = 0;
+  return new_hash;
+}
+
+hashmap *hashmap_alloc_incremental (hash_func func)
+{
+  hashmap *new_hash = hashmap_alloc (func);
+  if (new_hash != NULL)
+    {
+      new_hash->incremental = 1;
+    }
+  return new_hash;
+}
+
+hashmap_resize_policy hashmap_default_resize_policy (void)
+{
+  hashmap_resize_policy policy;
+  policy.growth_factor = HASH_MAP_GROWTH_FACTOR;
+  policy.max_load_factor = HASH_MAP_MAX_LOAD_FACTOR;
+  policy.min_load_factor = HASH_MAP_MIN_LOAD_FACTOR;
+  policy.min_capacity = HASH_MAP_MIN_SIZE;
+  policy.shrink_delay = 0;
+  policy.shrink_on_demand = 0;
+  return policy;
+}
+
+/**
+ * @return 1 if n is a power of 2, 0 otherwise
+ */
+int is_power_of_2 (size_t n)
+{
+  return n != 0 && (n & (n - 1)) == 0;
+}
+
+int hashmap_set_resize_policy (hashmap *hash_map,
+                               const hashmap_resize_policy *policy)
+{
+  if (hash_map == NULL || policy == NULL
+      || policy->growth_factor < 2 || !is_power_of_2 (policy->growth_factor)
+      || !is_power_of_2 (policy->min_capacity)
+      || policy->max_load_factor <= 0 || policy->min_load_factor < 0
+      || policy->min_load_factor * (double) policy->growth_factor
+         >= policy->max_load_factor)
+    {
+      return 0;
+    }
+  hash_map->policy = *policy;
+  hash_map->low_load_erases = 0;
+  if (hash_map->capacity >= policy->min_capacity)
+    {
+      return 1;
+    }
+  return reorganize_hash (hash_map, policy->min_capacity);
+}
+
+int hashmap_shrink_to_fit (hashmap *hash_map)
+{
+  if (hash_map == NULL)
+    {
+      return 0;
+    }
+  const hashmap_resize_policy *policy = &(hash_map->policy);
+  size_t new_cap = hash_map->capacity;
+  while (new_cap / policy->growth_factor >= policy->min_capacity
+         && (double) hash_map->size / (new_cap / policy->growth_factor)
+            < policy->max_load_factor)
+    {
+      new_cap /= policy->growth_factor;
+    }
+  hash_map->low_load_erases = 0;
+  if (new_cap == hash_map->capacity)
+    {
+      return 1;
+    }
+  return reorganize_hash (hash_map, new_cap);
+}
+
+hashmap *hashmap_alloc_with_arena (hash_func func)
+{
+  hashmap *new_hash = hashmap_alloc (func);
+  if (new_hash == NULL)
+    {
+      return NULL;
+    }
+  new_hash->arena = arena_alloc ();
+  if (new_hash->arena == NULL)
+    {
+      hashmap_free (&new_hash);
+    }
   return new_hash;
 }
 
 void hashmap_free (hashmap **p_hashmap)
 {
-  int cap = (int) (*p_hashmap)->capacity;
   if (p_hashmap == NULL || *p_hashmap == NULL)
     {
       return;
     }
-  buckets_free (&((*p_hashmap)->buckets), cap);
+  if ((*p_hashmap)->old_buckets != NULL)
+    {
+      buckets_free ((*p_hashmap)->arena, &((*p_hashmap)->old_buckets),
+                    (*p_hashmap)->old_capacity);
+    }
+  buckets_free ((*p_hashmap)->arena, &((*p_hashmap)->buckets),
+                (*p_hashmap)->capacity);
+  arena_free (&((*p_hashmap)->arena));
+#ifdef HASHMAP_STATS
+  free ((*p_hashmap)->stats);
+#endif
   free (*p_hashmap);
   *p_hashmap = NULL;
 }
+
 /**
- * re-organizes the hash-table after a change of size
- * @param hash hash table
- * @param mode 0-decrease size 1-increase size
- * @return 0 if failed, 1 if successful
+ * finds the pair with the key of in_pair, inserting a copy of in_pair if the
+ * key is not in the map. the key is hashed and looked up only once.
+ * @param hash_map hash table
+ * @param in_pair the pair to be inserted
+ * @param p_inserted out - 1 if in_pair was inserted, 0 if the key was found
+ * @return the pair in the map holding the key, NULL if failed
  */
-int reorganize_hash (hashmap *hash, int mode)
+pair *hashmap_find_or_insert (hashmap *hash_map, const pair *in_pair,
+                              int *p_inserted)
 {
-  int orig_cap;
-  int hash_cap = (int) hash->capacity;
-  if (mode == 1)
+  size_t hash = hash_map->hash_func (in_pair->key);
+  bucket *buck;
+  hashmap_entry **slot = hashmap_locate (hash_map, in_pair->key, hash, &buck);
+  *p_inserted = 0;
+  if (slot != NULL)
     {
-      orig_cap = (int) (hash_cap / HASH_MAP_GROWTH_FACTOR);
+      return &((*slot)->pair);
     }
-  else
+  migrate_step (hash_map);
+  hash_map->low_load_erases = 0;
+  if (hashmap_get_load_factor (hash_map)
+      >= hash_map->policy.max_load_factor) // add to capacity
     {
-      orig_cap = (int) (hash_cap * HASH_MAP_GROWTH_FACTOR);
+      if (reorganize_hash (hash_map, hash_map->capacity
+                                     * hash_map->policy.growth_factor) == 0)
+        {
+          return NULL;
+        }
     }
-  int vec_size, hash_res;
-  pair *p_temp;
-  void *v_temp;
-  void *p_copied;
-  vector **temp = buckets_alloc (hash->capacity);
-  if (temp == NULL)
+  hashmap_entry *copied = entry_alloc (hash_map->arena, in_pair, hash);
+  if (copied == NULL)
     {
-      return 0;
+      return NULL;
     }
-  for (int i = 0; i < orig_cap; ++i)
+  size_t index = complete_hash_func (hash, hash_map->capacity);
+  if (bucket_push_owned (hash_map->arena, &(hash_map->buckets[index]),
+                         copied) == 0)
     {
-      vec_size = (hash->buckets)[i]->size;
-      for (int j = 0; j < vec_size; ++j)
-        {
-          v_temp = (void *) hash->buckets[i]->data[j];
-          p_temp = (pair *) v_temp;
-          p_copied = pair_copy (v_temp);
-          if (p_copied == NULL)
-            {
-              return 0;
-            }
-          hash_res = complete_hash_func
-              (hash->hash_func (p_temp->key), hash_cap);
-          if (vector_push_back (temp[hash_res], p_copied) == 0)
-            {
-              pair_free (&p_copied);
-              buckets_free (&temp, hash_cap);
-              return 0;
-            }
-          pair_free (&p_copied);
-        }
+      entry_release (hash_map->arena, copied);
+      return NULL;
     }
-  buckets_free (&(hash->buckets), orig_cap);
-  hash->buckets = temp;
-  return 1;
+  hash_map->size++;
+  *p_inserted = 1;
+  return &(copied->pair);
 }
+
 int hashmap_insert (hashmap *hash_map, const pair *in_pair)
 {
-  int index, cap;
+  int inserted;
   if (hash_map == NULL || in_pair == NULL)
     {
       return 0;
     }
-  if (hashmap_at (hash_map, in_pair->key) != NULL)
+  if (hashmap_find_or_insert (hash_map, in_pair, &inserted) == NULL)
     {
       return 0;
     }
-//  pair *p_copied = (pair *) in_pair;
-  int orig_cap = (int) hash_map->capacity;
-  if (hashmap_get_load_factor (hash_map)
-      < HASH_MAP_MAX_LOAD_FACTOR) // no need to add to capacity
+  return inserted;
+}
+
+int hashmap_reserve (hashmap *hash_map, size_t n)
+{
+  if (hash_map == NULL)
     {
-      index = complete_hash_func
-          (hash_map->hash_func (in_pair->key), orig_cap);
-      if (vector_push_back (hash_map->buckets[index], in_pair) == 0)
-        {
-          return 0;
-        }
+      return 0;
     }
-  else // add to capacity
+  size_t new_cap = hash_map->capacity;
+  // the n-th insertion sees n - 1 pairs in the map
+  while (n > 0
+         && (double) (n - 1) / new_cap >= hash_map->policy.max_load_factor)
     {
-      hash_map->capacity *= HASH_MAP_GROWTH_FACTOR;
-      cap = (int) hash_map->capacity;
-      if (reorganize_hash (hash_map, 1) == 0)
+      new_cap *= hash_map->policy.growth_factor;
+    }
+  if (new_cap == hash_map->capacity)
+    {
+      return 1;
+    }
+  return reorganize_hash (hash_map, new_cap);
+}
+
+int hashmap_insert_bulk (hashmap *hash_map, const pair **pairs, size_t n)
+{
+  if (hash_map == NULL || pairs == NULL)
+    {
+      return -1;
+    }
+  // failing to reserve only costs the intermediate resizes
+  hashmap_reserve (hash_map, hash_map->size + n);
+  int count = 0;
+  for (size_t i = 0; i < n; ++i)
+    {
+      if (hashmap_insert (hash_map, pairs[i]) == 1)
         {
-          hash_map->capacity /= HASH_MAP_GROWTH_FACTOR;
-          return 0;
+          ++count;
         }
-      index = complete_hash_func (hash_map->hash_func (in_pair->key), cap);
-      if (vector_push_back (hash_map->buckets[index], in_pair) == 0)
+    }
+  return count;
+}
+
+valueT hashmap_try_emplace (hashmap *hash_map, const pair *in_pair,
+                            int *p_inserted)
+{
+  int inserted;
+  if (hash_map == NULL || in_pair == NULL)
+    {
+      return NULL;
+    }
+  pair *found = hashmap_find_or_insert (hash_map, in_pair, &inserted);
+  if (p_inserted != NULL)
+    {
+      *p_inserted = inserted;
+    }
+  if (found == NULL)
+    {
+      return NULL;
+    }
+  return found->value;
+}
+
+int hashmap_insert_or_assign (hashmap *hash_map, const pair *in_pair)
+{
+  int inserted;
+  if (hash_map == NULL || in_pair == NULL)
+    {
+      return 0;
+    }
+  pair *found = hashmap_find_or_insert (hash_map, in_pair, &inserted);
+  if (found == NULL)
+    {
+      return 0;
+    }
+  if (inserted == 0)
+    {
+      valueT new_value = in_pair->value_cpy (in_pair->value);
+      if (new_value == NULL)
         {
-          hash_map->capacity /= HASH_MAP_GROWTH_FACTOR;
           return 0;
         }
+      found->value_free (&(found->value));
+      found->value = new_value;
+      found->value_cpy = in_pair->value_cpy;
+      found->value_cmp = in_pair->value_cmp;
+      found->value_free = in_pair->value_free;
     }
-  hash_map->size++;
   return 1;
 }
 
-valueT hashmap_at (const hashmap *hash_map, const_keyT key)
+#ifdef HASHMAP_STATS
+/**
+ * counts the entries of a bucket a lookup compared
+ * @param slot the slot the lookup found, NULL if the key was not found
+ * @param p_found out - set to 1 if slot is in the bucket
+ * @return the number of entries compared
+ */
+size_t bucket_probes (const bucket *buck, hashmap_entry *const *slot,
+                      int *p_found)
+{
+  *p_found = 0;
+  if (buck->head == NULL)
+    {
+      return 0;
+    }
+  if (slot == &(buck->head))
+    {
+      *p_found = 1;
+      return 1;
+    }
+  if (buck->rest == NULL)
+    {
+      return 1;
+    }
+  if (slot != NULL && (void **) slot >= buck->rest->data
+      && (void **) slot < buck->rest->data + buck->rest->size)
+    {
+      *p_found = 1;
+      return 2 + (size_t) ((void **) slot - buck->rest->data);
+    }
+  return 1 + buck->rest->size;
+}
+
+/**
+ * counts a lookup, and the entries it compared
+ * @param slot the slot the lookup found, NULL if the key was not found
+ */
+void stats_count_lookup (const hashmap *hash_map, size_t hash,
+                         hashmap_entry *const *slot)
+{
+  size_t probes = 0;
+  int found = 0;
+  if (hash_map->old_buckets != NULL)
+    {
+      probes += bucket_probes (&(hash_map->old_buckets
+      [complete_hash_func (hash, hash_map->old_capacity)]), slot, &found);
+    }
+  if (!found)
+    {
+      probes += bucket_probes (&(hash_map->buckets
+      [complete_hash_func (hash, hash_map->capacity)]), slot, &found);
+    }
+  __atomic_fetch_add (&(hash_map->stats->lookups), 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add (&(hash_map->stats->lookup_probes), probes,
+                      __ATOMIC_RELAXED);
+}
+#endif
+
+const pair *hashmap_find (const hashmap *hash_map, const_keyT key)
 {
   if (hash_map == NULL || key == NULL)
     {
       return NULL;
     }
-  int cap = (int) hash_map->capacity;
-  int index = complete_hash_func (hash_map->hash_func (key), cap);
-  int vec_size = (int) hash_map->buckets[index]->size;
-  pair *temp;
-  for (int i = 0; i < vec_size; ++i)
+  bucket *buck;
+  size_t hash = hash_map->hash_func (key);
+  hashmap_entry **slot = hashmap_locate (hash_map, key, hash, &buck);
+#ifdef HASHMAP_STATS
+  stats_count_lookup (hash_map, hash, slot);
+#endif
+  if (slot == NULL)
     {
-      temp = (pair *) hash_map->buckets[index]->data[i];
-      if (temp->key_cmp (key, temp->key) == 1)
-        {
-          return temp->value;
-        }
+      return NULL;
     }
-  return NULL;
+  return &((*slot)->pair);
 }
 
-int hashmap_erase (hashmap *hash_map, const_keyT key)
+valueT hashmap_at (const hashmap *hash_map, const_keyT key)
 {
-  if (hash_map == NULL || key == NULL)
+  const pair *found = hashmap_find (hash_map, key);
+  if (found == NULL)
     {
-      return 0;
+      return NULL;
+    }
+  return found->value;
+}
+
+/**
+ * prefetches a bucket's first entry, and its overflow vector's array
+ */
+void bucket_prefetch (const bucket *buck)
+{
+  if (buck->head != NULL)
+    {
+      HASH_MAP_PREFETCH (buck->head);
     }
-  if (hashmap_at (hash_map, key) == NULL)
+  if (buck->rest != NULL)
     {
-      return 0;
+      HASH_MAP_PREFETCH (buck->rest->data);
     }
-  pair *temp;
-  int cap = (int) hash_map->capacity;
-  int index = complete_hash_func (hash_map->hash_func (key), cap);
-  int vec_size = (int) hash_map->buckets[index]->size;
-  if (hashmap_get_load_factor (hash_map)
-      > HASH_MAP_MIN_LOAD_FACTOR
-      || hash_map->capacity == HASH_MAP_MIN_SIZE) // no need to lower cap
+}
+
+int hashmap_at_batch (const hashmap *hash_map, const_keyT *keys, size_t n,
+                      valueT *out_values)
+{
+  if (hash_map == NULL || keys == NULL || out_values == NULL)
+    {
+      return -1;
+    }
+  size_t hashes[HASH_MAP_BATCH_STEP];
+  int count = 0;
+  for (size_t start = 0; start < n; start += HASH_MAP_BATCH_STEP)
     {
-      for (int i = 0; i < vec_size; ++i)
+      size_t step = n - start < HASH_MAP_BATCH_STEP ? n - start
+                                                    : HASH_MAP_BATCH_STEP;
+      const_keyT *step_keys = keys + start;
+      // first pass - hash the keys and prefetch their buckets
+      for (size_t i = 0; i < step; ++i)
         {
-          temp = (pair *) hash_map->buckets[index]->data[i];
-          if (temp->key_cmp (key, temp->key) == 1)
+          if (step_keys[i] == NULL)
+            {
+              continue;
+            }
+          hashes[i] = hash_map->hash_func (step_keys[i]);
+          if (hash_map->old_buckets != NULL)
             {
-//              size = (int) hash_map->buckets[index]->size;
-              if (vector_erase (hash_map->buckets[index], i) == 0)
-                {
-                  return 0;
-                }
-              --hash_map->size;
-              break;
+              HASH_MAP_PREFETCH (&(hash_map->old_buckets
+              [complete_hash_func (hashes[i], hash_map->old_capacity)]));
             }
+          HASH_MAP_PREFETCH (&(hash_map->buckets
+          [complete_hash_func (hashes[i], hash_map->capacity)]));
         }
-    }
-  else // lower cap
-    {
-      hash_map->capacity /= HASH_MAP_GROWTH_FACTOR;
-      if (reorganize_hash (hash_map, 0) == 0)
+      // second pass - prefetch the entries of the buckets
+      for (size_t i = 0; i < step; ++i)
         {
-          hash_map->capacity *= HASH_MAP_GROWTH_FACTOR;
-          return 0;
+          if (step_keys[i] == NULL)
+            {
+              continue;
+            }
+          if (hash_map->old_buckets != NULL)
+            {
+              bucket_prefetch (&(hash_map->old_buckets
+              [complete_hash_func (hashes[i], hash_map->old_capacity)]));
+            }
+          bucket_prefetch (&(hash_map->buckets
+          [complete_hash_func (hashes[i], hash_map->capacity)]));
         }
-      cap = (int) hash_map->capacity;
-      index = complete_hash_func (hash_map->hash_func (key), cap);
-      vec_size = (int) hash_map->buckets[index]->size;
-      for (int i = 0; i < vec_size; ++i)
+      // third pass - resolve the keys
+      for (size_t i = 0; i < step; ++i)
         {
-          temp = (pair *) hash_map->buckets[index]->data[i];
-          if (temp->key_cmp (key, temp->key) == 1)
+          out_values[start + i] = NULL;
+          if (step_keys[i] == NULL)
             {
-              if (vector_erase (hash_map->buckets[index], i) == 0)
-                {
-                  hash_map->capacity /= HASH_MAP_GROWTH_FACTOR;
-                  return 0;
-                }
-              --hash_map->size;
-              break;
+              continue;
+            }
+          bucket *buck;
+          hashmap_entry **slot = hashmap_locate (hash_map, step_keys[i],
+                                                 hashes[i], &buck);
+#ifdef HASHMAP_STATS
+          stats_count_lookup (hash_map, hashes[i], slot);
+#endif
+          if (slot != NULL)
+            {
+              out_values[start + i] = (*slot)->pair.value;
+              ++count;
             }
         }
     }
-  return 1;
+  return count;
+}
 
+int hashmap_erase (hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return 0;
+    }
+  bucket *buck;
+  hashmap_entry **slot = hashmap_locate (hash_map, key,
+                                         hash_map->hash_func (key), &buck);
+  if (slot == NULL)
+    {
+      return 0;
+    }
+  // the load factor before the erase decides whether to lower the cap
+  const hashmap_resize_policy *policy = &(hash_map->policy);
+  int shrink = 0;
+  if (hashmap_get_load_factor (hash_map) > policy->min_load_factor
+      || hash_map->capacity / policy->growth_factor < policy->min_capacity)
+    {
+      hash_map->low_load_erases = 0;
+    }
+  else if (!policy->shrink_on_demand
+           && ++hash_map->low_load_erases > policy->shrink_delay)
+    {
+      shrink = 1;
+      hash_map->low_load_erases = 0;
+    }
+  if (bucket_erase (hash_map->arena, buck, slot) == 0)
+    {
+      return 0;
+    }
+  --hash_map->size;
+  migrate_step (hash_map);
+  if (shrink)
+    {
+      // a failed shrink leaves a valid (just sparse) map behind
+      reorganize_hash (hash_map, hash_map->capacity / policy->growth_factor);
+    }
+  return 1;
 }
 
 double hashmap_get_load_factor (const hashmap *hash_map)
@@ -268,6 +934,51 @@ double hashmap_get_load_factor (const hashmap *hash_map)
   return (double) hash_map->size / hash_map->capacity;
 }
 
+/**
+ * applies valT_func on the value of a pair if its key meets keyT_func
+ * @return 1 if the value was changed, 0 otherwise
+ */
+int pair_apply_if (const pair *temp, keyT_func keyT_func,
+                   valueT_func valT_func)
+{
+  if (keyT_func (temp->key) == 1)
+    {
+      valT_func (temp->value);
+      return 1;
+    }
+  return 0;
+}
+
+/**
+ * applies valT_func on the values of a bucket array whose keys meet keyT_func
+ * @return number of changed values
+ */
+int buckets_apply_if (const bucket *buckets, size_t from, size_t cap,
+                      keyT_func keyT_func, valueT_func valT_func)
+{
+  int count = 0;
+  for (size_t i = from; i < cap; ++i)
+    {
+      if (buckets[i].head == NULL)
+        {
+          continue;
+        }
+      count += pair_apply_if (&(buckets[i].head->pair),
+                              keyT_func, valT_func);
+      if (buckets[i].rest == NULL)
+        {
+          continue;
+        }
+      for (size_t j = 0; j < buckets[i].rest->size; ++j)
+        {
+          count += pair_apply_if
+              (&(((hashmap_entry *) buckets[i].rest->data[j])->pair),
+               keyT_func, valT_func);
+        }
+    }
+  return count;
+}
+
 int
 hashmap_apply_if (const hashmap *hash_map,
                   keyT_func keyT_func, valueT_func valT_func)
@@ -276,21 +987,284 @@ hashmap_apply_if (const hashmap *hash_map,
     {
       return -1;
     }
-  pair *temp;
   int count = 0;
-  int vec_size, hash_cap = (int) hash_map->capacity;
-  for (int i = 0; i < hash_cap; ++i)
+  if (hash_map->old_buckets != NULL)
+    {
+      count += buckets_apply_if (hash_map->old_buckets,
+                                 hash_map->migrate_index,
+                                 hash_map->old_capacity,
+                                 keyT_func, valT_func);
+    }
+  count += buckets_apply_if (hash_map->buckets, 0, hash_map->capacity,
+                             keyT_func, valT_func);
+  return count;
+}
+
+/**
+ * @struct apply_range
+ * A range of the buckets visited by one thread of hashmap_apply_if_parallel.
+ * The old buckets still to be migrated come first, then the new ones.
+ * @param hash_map the hash map.
+ * @param from the first bucket of the range.
+ * @param to the bucket after the last of the range.
+ * @param keyT_func the condition on the keys.
+ * @param valT_func the modification of the values.
+ * @param count out - number of changed values.
+ */
+typedef struct apply_range {
+    const hashmap *hash_map;
+    size_t from;
+    size_t to;
+    keyT_func keyT_func;
+    valueT_func valT_func;
+    int count;
+} apply_range;
+
+/**
+ * visits the buckets of an apply_range (pthread start routine)
+ * @param arg pointer to an apply_range
+ * @return NULL
+ */
+void *apply_range_run (void *arg)
+{
+  apply_range *range = (apply_range *) arg;
+  const hashmap *hash_map = range->hash_map;
+  size_t old_left = 0;
+  range->count = 0;
+  if (hash_map->old_buckets != NULL)
+    {
+      old_left = hash_map->old_capacity - hash_map->migrate_index;
+    }
+  if (range->from < old_left)
+    {
+      range->count += buckets_apply_if
+          (hash_map->old_buckets, hash_map->migrate_index + range->from,
+           hash_map->migrate_index + (range->to < old_left ? range->to
+                                                            : old_left),
+           range->keyT_func, range->valT_func);
+    }
+  if (range->to > old_left)
+    {
+      range->count += buckets_apply_if
+          (hash_map->buckets,
+           range->from > old_left ? range->from - old_left : 0,
+           range->to - old_left, range->keyT_func, range->valT_func);
+    }
+  return NULL;
+}
+
+int hashmap_apply_if_parallel (const hashmap *hash_map, keyT_func keyT_func,
+                               valueT_func valT_func, size_t n_threads)
+{
+  if (hash_map == NULL || keyT_func == NULL || valT_func == NULL)
+    {
+      return -1;
+    }
+  size_t total = hash_map->capacity;
+  if (hash_map->old_buckets != NULL)
+    {
+      total += hash_map->old_capacity - hash_map->migrate_index;
+    }
+  if (n_threads > total)
+    {
+      n_threads = total;
+    }
+  if (n_threads <= 1)
+    {
+      return hashmap_apply_if (hash_map, keyT_func, valT_func);
+    }
+  apply_range *ranges = (apply_range *) malloc (sizeof (apply_range)
+                                                * n_threads);
+  pthread_t *threads = (pthread_t *) malloc (sizeof (pthread_t) * n_threads);
+  int *started = (int *) calloc (n_threads, sizeof (int));
+  if (ranges == NULL || threads == NULL || started == NULL)
+    {
+      free (ranges);
+      free (threads);
+      free (started);
+      return hashmap_apply_if (hash_map, keyT_func, valT_func);
+    }
+  for (size_t i = 0; i < n_threads; ++i)
+    {
+      ranges[i].hash_map = hash_map;
+      ranges[i].from = total * i / n_threads;
+      ranges[i].to = total * (i + 1) / n_threads;
+      ranges[i].keyT_func = keyT_func;
+      ranges[i].valT_func = valT_func;
+      if (i > 0)
+        {
+          started[i] = pthread_create (&threads[i], NULL, apply_range_run,
+                                       &ranges[i]) == 0;
+        }
+    }
+  int count = 0;
+  for (size_t i = 0; i < n_threads; ++i)
+    {
+      if (started[i])
+        {
+          pthread_join (threads[i], NULL);
+        }
+      else // the calling thread's range, or a thread that failed to start
+        {
+          apply_range_run (&ranges[i]);
+        }
+      count += ranges[i].count;
+    }
+  free (ranges);
+  free (threads);
+  free (started);
+  return count;
+}
+
+/**
+ * moves an iterator to the first entry at (or after) its position
+ * @return 1 if the iterator is on an entry, 0 if the iteration ended
+ */
+int iter_settle (hashmap_iter *iter)
+{
+  const hashmap *hash_map = iter->hash_map;
+  const bucket *buck;
+  size_t cap;
+  while (1)
     {
-      vec_size = (int) hash_map->buckets[i]->size;
-      for (int j = 0; j < vec_size; ++j)
+      cap = iter->buckets == hash_map->buckets ? hash_map->capacity
+                                               : hash_map->old_capacity;
+      for (; iter->bucket < cap; ++iter->bucket, iter->pos = 0)
         {
-          temp = hash_map->buckets[i]->data[j];
-          if (keyT_func (temp->key) == 1)
+          buck = &(iter->buckets[iter->bucket]);
+          if (buck->head == NULL) // an empty bucket has no rest either
             {
-              valT_func (temp->value);
-              ++count;
+              continue;
+            }
+          if (iter->pos == 0)
+            {
+              iter->entry = buck->head;
+              return 1;
             }
+          if (buck->rest != NULL && iter->pos - 1 < buck->rest->size)
+            {
+              iter->entry = (hashmap_entry *) buck->rest->data[iter->pos - 1];
+              return 1;
+            }
+        }
+      if (iter->buckets == hash_map->buckets)
+        {
+          iter->entry = NULL;
+          return 0;
         }
+      iter->buckets = hash_map->buckets; // the old buckets are done
+      iter->bucket = 0;
+      iter->pos = 0;
     }
-  return count;
-}
\ No newline at end of file
+}
+
+int hashmap_iter_begin (const hashmap *hash_map, hashmap_iter *iter)
+{
+  if (iter == NULL)
+    {
+      return 0;
+    }
+  iter->hash_map = hash_map;
+  iter->entry = NULL;
+  if (hash_map == NULL)
+    {
+      return 0;
+    }
+  iter->pos = 0;
+  if (hash_map->old_buckets != NULL)
+    {
+      iter->buckets = hash_map->old_buckets;
+      iter->bucket = hash_map->migrate_index;
+    }
+  else
+    {
+      iter->buckets = hash_map->buckets;
+      iter->bucket = 0;
+    }
+  return iter_settle (iter);
+}
+
+int hashmap_iter_next (hashmap_iter *iter)
+{
+  if (iter == NULL || iter->entry == NULL)
+    {
+      return 0;
+    }
+  ++iter->pos;
+  return iter_settle (iter);
+}
+
+const_keyT hashmap_iter_key (const hashmap_iter *iter)
+{
+  if (iter == NULL || iter->entry == NULL)
+    {
+      return NULL;
+    }
+  return iter->entry->pair.key;
+}
+
+valueT hashmap_iter_value (const hashmap_iter *iter)
+{
+  if (iter == NULL || iter->entry == NULL)
+    {
+      return NULL;
+    }
+  return iter->entry->pair.value;
+}
+
+/**
+ * adds the chain lengths and the memory of a bucket array to the statistics
+ */
+void buckets_stats (const bucket *buckets, size_t from, size_t cap,
+                    hashmap_statistics *out)
+{
+  size_t length;
+  out->bytes_allocated += sizeof (bucket) * cap;
+  for (size_t i = from; i < cap; ++i)
+    {
+      length = 0;
+      if (buckets[i].head != NULL)
+        {
+          length = 1;
+          out->bytes_allocated += sizeof (hashmap_entry);
+        }
+      if (buckets[i].rest != NULL)
+        {
+          length += buckets[i].rest->size;
+          out->bytes_allocated += sizeof (vector)
+                                  + sizeof (void *) * buckets[i].rest->capacity
+                                  + sizeof (hashmap_entry)
+                                    * buckets[i].rest->size;
+        }
+      ++out->chain_lengths[length < HASH_MAP_STATS_MAX_CHAIN
+                           ? length : HASH_MAP_STATS_MAX_CHAIN];
+    }
+}
+
+int hashmap_stats (const hashmap *hash_map, hashmap_statistics *out)
+{
+  if (hash_map == NULL || out == NULL)
+    {
+      return 0;
+    }
+#ifdef HASHMAP_STATS
+  memset (out, 0, sizeof (hashmap_statistics));
+  out->rehash_count = hash_map->stats->rehash_count;
+  out->rehash_ns = hash_map->stats->rehash_ns;
+  out->lookups = __atomic_load_n (&(hash_map->stats->lookups),
+                                  __ATOMIC_RELAXED);
+  size_t probes = __atomic_load_n (&(hash_map->stats->lookup_probes),
+                                   __ATOMIC_RELAXED);
+  out->avg_probes = out->lookups == 0 ? 0 : (double) probes / out->lookups;
+  out->bytes_allocated = sizeof (hashmap) + sizeof (struct hashmap_counters);
+  if (hash_map->old_buckets != NULL)
+    {
+      buckets_stats (hash_map->old_buckets, hash_map->migrate_index,
+                     hash_map->old_capacity, out);
+    }
+  buckets_stats (hash_map->buckets, 0, hash_map->capacity, out);
+  return 1;
+#else
+  return 0;
+#endif
+}
@@ -4,11 +4,12 @@
 #include <stdlib.h>
 #include "vector.h"
 #include "pair.h"
+#include "arena.h"
 
 /**
  * @def HASH_MAP_INITIAL_CAP
  * The initial capacity of the hash map.
- * It means, the initial number of <b> vectors </b> the hash map has.
+ * It means, the initial number of <b> buckets </b> the hash map has.
  */
 #define HASH_MAP_INITIAL_CAP 16UL
 
@@ -27,7 +28,7 @@
  * Example: if the hash_map capacity is 16,
  * and it has 4 elements in it (size is 4),
  * if an element is erased, the load factor drops below 0.25,
- * so the hash map should be minimized (to 8 vectors).
+ * so the hash map should be minimized (to 8 buckets).
  */
 #define HASH_MAP_MIN_LOAD_FACTOR 0.25
 
@@ -37,10 +38,31 @@
  * Example: if the hash_map capacity is 16,
  * and it has 12 elements in it (size is 12),
  * if another element is added, the load factor goes above 0.75,
- * so the hash map should be extended (to 32 vectors).
+ * so the hash map should be extended (to 32 buckets).
  */
 #define HASH_MAP_MAX_LOAD_FACTOR 0.75
 
+/**
+ * @def HASH_MAP_MIGRATE_STEP
+ * The number of old buckets an incremental hash map migrates to its new
+ * bucket array on every insert / erase while a resize is in progress.
+ */
+#define HASH_MAP_MIGRATE_STEP 8UL
+
+/**
+ * @def HASH_MAP_STATS_MAX_CHAIN
+ * The longest chain length counted on its own by hashmap_stats, longer
+ * chains are counted together with it.
+ */
+#define HASH_MAP_STATS_MAX_CHAIN 8
+
+/**
+ * @def HASH_MAP_BATCH_STEP
+ * The number of keys hashmap_at_batch has in flight at once - their buckets
+ * and entries are prefetched together before any of them is compared.
+ */
+#define HASH_MAP_BATCH_STEP 16UL
+
 /**
  * @typedef hash_func
  * This type of function receives a keyT and returns
@@ -64,20 +86,141 @@ typedef int (*keyT_func) (const_keyT);
  */
 typedef void (*valueT_func) (valueT);
 
+/**
+ * @struct hashmap_entry
+ * A pair stored in the hash map, along with the full hash of its key - a
+ * resize never calls hash_func again, and a lookup calls key_cmp only on
+ * entries whose hash matches.
+ * @param hash the result of hash_func on the pair's key.
+ * @param pair the pair, its key and value are copies owned by the map.
+ */
+typedef struct hashmap_entry {
+    size_t hash;
+    pair pair;
+} hashmap_entry;
+
+/**
+ * @struct bucket
+ * A single bucket of the hash map. Nothing is allocated for an empty bucket,
+ * and a bucket holding a single pair (the common case) needs no vector.
+ * @param head the first entry of the bucket, NULL if the bucket is empty.
+ * @param rest the other entries of the bucket, allocated on the first
+ * collision only (NULL otherwise).
+ */
+typedef struct bucket {
+    hashmap_entry *head;
+    vector *rest;
+} bucket;
+
+/**
+ * @struct hashmap_resize_policy
+ * When and how a hash map resizes. The default policy (hashmap_alloc's) is
+ * HASH_MAP_GROWTH_FACTOR, HASH_MAP_MAX_LOAD_FACTOR, HASH_MAP_MIN_LOAD_FACTOR,
+ * a minimal capacity of 1, no shrink delay and shrinking on erase.
+ * @param growth_factor the capacity is multiplied / divided by it on
+ * resize (a power of 2, at least 2).
+ * @param max_load_factor an insertion that sees the load factor at (or
+ * above) it extends the map first.
+ * @param min_load_factor an erase that sees the load factor at (or below)
+ * it may lower the capacity. min_load_factor * growth_factor must be below
+ * max_load_factor, so a shrink never calls for an immediate extension.
+ * @param min_capacity the capacity the map never shrinks below (a power of
+ * 2).
+ * @param shrink_delay the number of erases in a row (with no insertion in
+ * between) that must see a low load factor before the map shrinks - a map
+ * oscillating around min_load_factor is not resized back and forth.
+ * @param shrink_on_demand 1 if erases never shrink the map (only
+ * hashmap_shrink_to_fit does), 0 otherwise.
+ */
+typedef struct hashmap_resize_policy {
+    size_t growth_factor;
+    double max_load_factor;
+    double min_load_factor;
+    size_t min_capacity;
+    size_t shrink_delay;
+    int shrink_on_demand;
+} hashmap_resize_policy;
+
+/**
+ * @struct hashmap_statistics
+ * The statistics of a hash map, see hashmap_stats.
+ * @param rehash_count the number of resizes (reorganize_hash) so far.
+ * @param rehash_ns the time spent on resizing so far (including the
+ * incremental migration steps), in nanoseconds.
+ * @param chain_lengths chain_lengths[i] is the number of buckets holding i
+ * pairs, the last element counts the buckets holding
+ * HASH_MAP_STATS_MAX_CHAIN pairs or more.
+ * @param lookups the number of lookups (hashmap_at / hashmap_find) so far.
+ * @param avg_probes the average number of entries a lookup compared.
+ * @param bytes_allocated the memory of the map's own structure (bucket
+ * arrays, entries, overflow vectors) - the keys and values not included.
+ */
+typedef struct hashmap_statistics {
+    size_t rehash_count;
+    double rehash_ns;
+    size_t chain_lengths[HASH_MAP_STATS_MAX_CHAIN + 1];
+    size_t lookups;
+    double avg_probes;
+    size_t bytes_allocated;
+} hashmap_statistics;
+
 /**
  * @struct hashmap
- * @param buckets dynamic array of vectors which stores the values.
+ * @param buckets dynamic array of buckets which stores the values.
  * @param size the number of elements (pairs) stored in the hash map.
  * @param capacity the number of buckets in the hash map.
  * @param hash_func a function which "hashes" keys.
+ * @param incremental 1 if a resize migrates the buckets gradually
+ * (HASH_MAP_MIGRATE_STEP per operation), 0 if it migrates them at once.
+ * @param old_buckets the bucket array a resize migrates from, NULL when no
+ * resize is in progress. A migrated bucket is left empty.
+ * @param old_capacity the number of buckets in old_buckets.
+ * @param migrate_index the next old bucket to be migrated.
+ * @param arena the arena the entries and the overflow vectors are taken
+ * from, NULL if they are taken from malloc.
+ * @param policy the resize policy of the map.
+ * @param low_load_erases the number of erases in a row which saw a low load
+ * factor (see hashmap_resize_policy's shrink_delay).
+ * @param stats the counters of hashmap_stats (only if compiled with
+ * HASHMAP_STATS).
  */
 typedef struct hashmap {
-    vector **buckets;
+    bucket *buckets;
     size_t size;
     size_t capacity; // num of buckets
     hash_func hash_func;
+    int incremental;
+    bucket *old_buckets;
+    size_t old_capacity;
+    size_t migrate_index;
+    arena *arena;
+    hashmap_resize_policy policy;
+    size_t low_load_erases;
+#ifdef HASHMAP_STATS
+    struct hashmap_counters *stats;
+#endif
 } hashmap;
 
+/**
+ * @struct hashmap_iter
+ * A cursor over the pairs of a hash map - the old bucket array's pairs still
+ * to be migrated first (during an incremental resize), then the current
+ * array's. Any modification of the map invalidates it.
+ * @param hash_map the hash map iterated.
+ * @param buckets the bucket array being walked.
+ * @param bucket the index of the current bucket in buckets.
+ * @param pos the current entry of the bucket, 0 for its head, j + 1 for
+ * rest->data[j].
+ * @param entry the current entry, NULL once the iteration ended.
+ */
+typedef struct hashmap_iter {
+    const hashmap *hash_map;
+    const bucket *buckets;
+    size_t bucket;
+    size_t pos;
+    hashmap_entry *entry;
+} hashmap_iter;
+
 /**
  * Allocates dynamically new hash map element.
  * @param func a function which "hashes" keys.
@@ -86,6 +229,56 @@ typedef struct hashmap {
  */
 hashmap *hashmap_alloc (hash_func func);
 
+/**
+ * Allocates dynamically new hash map element which resizes incrementally:
+ * a resize keeps both the old and the new bucket arrays and every following
+ * insert / erase migrates a bounded number of old buckets, so no single
+ * operation pays for rehashing the whole map.
+ * @param func a function which "hashes" keys.
+ * @return pointer to dynamically allocated hashmap.
+ * @if_fail return NULL.
+ */
+hashmap *hashmap_alloc_incremental (hash_func func);
+
+/**
+ * Allocates dynamically new hash map element whose entries and overflow
+ * vectors are taken from an arena of slab pools the map owns: inserting
+ * many small pairs costs a few large allocations instead of one per entry,
+ * and hashmap_free gives the map's own memory back one slab at a time. The
+ * copies of the keys and values are still made (and freed) by the pairs'
+ * own key_cpy / value_cpy (key_free / value_free).
+ * @param func a function which "hashes" keys.
+ * @return pointer to dynamically allocated hashmap.
+ * @if_fail return NULL.
+ */
+hashmap *hashmap_alloc_with_arena (hash_func func);
+
+/**
+ * @return the default resize policy (see hashmap_resize_policy).
+ */
+hashmap_resize_policy hashmap_default_resize_policy (void);
+
+/**
+ * Replaces the resize policy of a hash map. If the map's capacity is below
+ * the policy's min_capacity, it is extended right away.
+ * @param hash_map a hash map.
+ * @param policy the new policy (copied).
+ * @return 1 if successful, 0 otherwise (also if the policy is invalid - see
+ * hashmap_resize_policy, the map keeps its policy then).
+ */
+int hashmap_set_resize_policy (hashmap *hash_map,
+                               const hashmap_resize_policy *policy);
+
+/**
+ * Lowers the capacity of the hash map as far as its policy allows without
+ * an insertion extending it right away (min_capacity, and a load factor
+ * below max_load_factor). Meant for maps with shrink_on_demand, but works
+ * with any policy.
+ * @param hash_map a hash map.
+ * @return 1 if successful (also if the map could not shrink), 0 otherwise.
+ */
+int hashmap_shrink_to_fit (hashmap *hash_map);
+
 /**
  * Frees a hash map and the elements the hash map itself allocated.
  * @param p_hash_map pointer to dynamically allocated pointer to hash_map.
@@ -102,6 +295,50 @@ void hashmap_free (hashmap **p_hash_map);
  */
 int hashmap_insert (hashmap *hash_map, const pair *in_pair);
 
+/**
+ * Inserts a copy of in_pair to the hash map if its key is not in the map yet,
+ * otherwise leaves the map unchanged. The key is hashed and looked up once.
+ * @param hash_map the hash map to be inserted with new element.
+ * @param in_pair a in_pair the hash map would contain.
+ * @param p_inserted out (may be NULL) - set to 1 if in_pair was inserted,
+ * 0 if the key was already in the map.
+ * @return the value associated with the key after the call (the value itself,
+ * not a copy of it), NULL if the function failed.
+ */
+valueT hashmap_try_emplace (hashmap *hash_map, const pair *in_pair,
+                            int *p_inserted);
+
+/**
+ * Inserts a copy of in_pair to the hash map, or if its key is already in the
+ * map, replaces the associated value with a copy of in_pair's value.
+ * The key is hashed and looked up once.
+ * @param hash_map the hash map to be inserted with new element.
+ * @param in_pair a in_pair the hash map would contain.
+ * @return returns 1 for successful insertion / assignment, 0 otherwise.
+ */
+int hashmap_insert_or_assign (hashmap *hash_map, const pair *in_pair);
+
+/**
+ * Extends the hash map (once) so that it holds n pairs without exceeding
+ * HASH_MAP_MAX_LOAD_FACTOR, i.e. inserting up to n pairs triggers no resize.
+ * The hash map is never minimized by this function.
+ * @param hash_map a hash map.
+ * @param n the number of pairs the hash map should be able to hold.
+ * @return 1 if successful, 0 otherwise.
+ */
+int hashmap_reserve (hashmap *hash_map, size_t n);
+
+/**
+ * Inserts copies of n pairs to the hash map, resizing it at most once
+ * beforehand (see hashmap_reserve). A pair whose key is already in the map
+ * (or NULL) is skipped.
+ * @param hash_map the hash map to be inserted with new elements.
+ * @param pairs an array of n pairs.
+ * @param n the number of pairs in the array.
+ * @return number of inserted pairs, -1 on bad input.
+ */
+int hashmap_insert_bulk (hashmap *hash_map, const pair **pairs, size_t n);
+
 /**
  * The function returns the value associated with the given key.
  * @param hash_map a hash map.
@@ -111,6 +348,30 @@ int hashmap_insert (hashmap *hash_map, const pair *in_pair);
  */
 valueT hashmap_at (const hashmap *hash_map, const_keyT key);
 
+/**
+ * Looks up n keys at once, like n calls to hashmap_at. The keys are hashed
+ * and their buckets, then their first entries, are prefetched in groups of
+ * HASH_MAP_BATCH_STEP before they are compared, so the cache misses of the
+ * lookups overlap instead of following one another.
+ * @param hash_map a hash map.
+ * @param keys an array of n keys (a NULL key is not found).
+ * @param n the number of keys in the array.
+ * @param out_values out - an array of n values, out_values[i] is set to the
+ * value associated with keys[i] if exists, NULL otherwise.
+ * @return number of keys found, -1 on bad input.
+ */
+int hashmap_at_batch (const hashmap *hash_map, const_keyT *keys, size_t n,
+                      valueT *out_values);
+
+/**
+ * The function returns the pair holding the given key.
+ * @param hash_map a hash map.
+ * @param key the key to be checked.
+ * @return the pair in the map holding key if exists (owned by the map, valid
+ * until the map is modified), NULL otherwise.
+ */
+const pair *hashmap_find (const hashmap *hash_map, const_keyT key);
+
 /**
  * The function erases the pair associated with key.
  * @param hash_map a hash map.
@@ -141,4 +402,66 @@ double hashmap_get_load_factor (const hashmap *hash_map);
  * @return number of changed values
  */
 int hashmap_apply_if (const hashmap *hash_map, keyT_func keyT_func, valueT_func valT_func);//const
+
+/**
+ * Like hashmap_apply_if, but the buckets are split into n_threads
+ * contiguous ranges, each visited by its own thread (the calling thread
+ * takes the first range).
+ * Every pair is visited exactly once, as long as the map is not modified
+ * during the call. keyT_func and valT_func are called concurrently (on
+ * different pairs), so they must be thread safe.
+ * @param hash_map a hashmap
+ * @param keyT_func a function that checks a condition on keyT and return 1 if true, 0 else
+ * @param valT_func a function that modifies valueT, in-place
+ * @param n_threads the number of threads to use (0 or 1 - no extra threads)
+ * @return number of changed values, -1 on bad input
+ */
+int hashmap_apply_if_parallel (const hashmap *hash_map, keyT_func keyT_func,
+                               valueT_func valT_func, size_t n_threads);
+
+/**
+ * Starts an iteration over the pairs of a hash map, in no particular order:
+ *   hashmap_iter it;
+ *   for (int more = hashmap_iter_begin (hash_map, &it); more;
+ *        more = hashmap_iter_next (&it))
+ *     { ... hashmap_iter_key (&it) ... hashmap_iter_value (&it) ... }
+ * Only occupied buckets are visited entry by entry, the empty ones are
+ * skipped with a single check each.
+ * @param hash_map a hash map, not to be modified during the iteration.
+ * @param iter the iterator to be set to the first pair.
+ * @return 1 if iter is on a pair, 0 if the map is empty (or on bad input).
+ */
+int hashmap_iter_begin (const hashmap *hash_map, hashmap_iter *iter);
+
+/**
+ * Advances an iterator to the next pair.
+ * @param iter an iterator started by hashmap_iter_begin.
+ * @return 1 if iter is on a pair, 0 if the iteration ended.
+ */
+int hashmap_iter_next (hashmap_iter *iter);
+
+/**
+ * @param iter an iterator.
+ * @return the key of the current pair (owned by the map, must not be
+ * modified), NULL if the iteration ended.
+ */
+const_keyT hashmap_iter_key (const hashmap_iter *iter);
+
+/**
+ * @param iter an iterator.
+ * @return the value of the current pair (owned by the map, may be modified
+ * in place), NULL if the iteration ended.
+ */
+valueT hashmap_iter_value (const hashmap_iter *iter);
+
+/**
+ * Fills the statistics of the hash map. The counters are kept only if the
+ * library is compiled with HASHMAP_STATS defined (`make STATS=1`), so they
+ * cost nothing otherwise.
+ * @param hash_map a hash map.
+ * @param out the statistics to be filled.
+ * @return 1 if successful, 0 on bad input or if the statistics are not
+ * compiled in.
+ */
+int hashmap_stats (const hashmap *hash_map, hashmap_statistics *out);
 #endif //HASHMAP_H_
@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include "hashmap.h"
+#include "test_pairs.h"
+#include "hash_funcs.h"
+#include "bench_utils.h"
+
+/*
+ * Compares hashmap_at_batch against a loop of hashmap_at, on random keys
+ * (half of them missing) of maps from cache sized to far larger than the
+ * caches.
+ * usage: hashmap_batch_bench [lookups per map]
+ */
+
+#define BENCH_BATCH 256
+#define BENCH_DEFAULT_LOOKUPS (1UL << 22)
+
+/**
+ * fills a map with the keys 0, 2, 4, ... (2 * n - 2)
+ * @return the map, NULL if failed
+ */
+static hashmap *bench_fill (size_t n)
+{
+  hashmap *hash_map = hashmap_alloc (hash_int);
+  if (hash_map == NULL || hashmap_reserve (hash_map, n) == 0)
+    {
+      hashmap_free (&hash_map);
+      return NULL;
+    }
+  for (size_t i = 0; i < n; ++i)
+    {
+      int key = (int) (2 * i);
+      void *in_pair = pair_alloc (&key, &key, int_value_cpy, int_value_cpy,
+                                  int_value_cmp, int_value_cmp,
+                                  int_value_free, int_value_free);
+      int inserted = in_pair != NULL && hashmap_insert (hash_map, in_pair);
+      pair_free (&in_pair);
+      if (!inserted)
+        {
+          hashmap_free (&hash_map);
+          return NULL;
+        }
+    }
+  return hash_map;
+}
+
+/**
+ * looks up the keys one hashmap_at at a time
+ * @return the number of keys found
+ */
+static size_t bench_loop (const hashmap *hash_map, const int *keys,
+                          size_t lookups)
+{
+  size_t found = 0;
+  for (size_t i = 0; i < lookups; ++i)
+    {
+      found += hashmap_at (hash_map, &keys[i]) != NULL;
+    }
+  return found;
+}
+
+/**
+ * looks up the keys BENCH_BATCH at a time with hashmap_at_batch
+ * @return the number of keys found
+ */
+static size_t bench_batch (const hashmap *hash_map, const int *keys,
+                           size_t lookups)
+{
+  const_keyT key_ptrs[BENCH_BATCH];
+  valueT values[BENCH_BATCH];
+  size_t found = 0;
+  for (size_t start = 0; start < lookups; start += BENCH_BATCH)
+    {
+      size_t n = lookups - start < BENCH_BATCH ? lookups - start
+                                               : BENCH_BATCH;
+      for (size_t i = 0; i < n; ++i)
+        {
+          key_ptrs[i] = &keys[start + i];
+        }
+      found += (size_t) hashmap_at_batch (hash_map, key_ptrs, n, values);
+    }
+  return found;
+}
+
+int main (int argc, char *argv[])
+{
+  size_t lookups = argc > 1 ? strtoul (argv[1], NULL, 10)
+                            : BENCH_DEFAULT_LOOKUPS;
+  if (lookups == 0)
+    {
+      lookups = BENCH_DEFAULT_LOOKUPS;
+    }
+  int *keys = (int *) malloc (lookups * sizeof (int));
+  if (keys == NULL)
+    {
+      return EXIT_FAILURE;
+    }
+  printf ("%lu random lookups per map, batches of %d\n",
+          (unsigned long) lookups, BENCH_BATCH);
+  printf ("%10s %14s %14s %10s\n", "keys", "at ns/op", "batch ns/op",
+          "speedup");
+  unsigned long long state = 88172645463325252ULL;
+  for (size_t n = 1UL << 10; n <= 1UL << 22; n <<= 2)
+    {
+      hashmap *hash_map = bench_fill (n);
+      if (hash_map == NULL)
+        {
+          free (keys);
+          return EXIT_FAILURE;
+        }
+      for (size_t i = 0; i < lookups; ++i)
+        {
+          keys[i] = (int) (bench_rand (&state) % (2 * n)); // half missing
+        }
+      double start = bench_now_ns ();
+      size_t found_loop = bench_loop (hash_map, keys, lookups);
+      double loop_ns = (bench_now_ns () - start) / (double) lookups;
+      start = bench_now_ns ();
+      size_t found_batch = bench_batch (hash_map, keys, lookups);
+      double batch_ns = (bench_now_ns () - start) / (double) lookups;
+      if (found_loop != found_batch)
+        {
+          fprintf (stderr, "%lu keys: the results differ\n",
+                   (unsigned long) n);
+        }
+      printf ("%10lu %14.2f %14.2f %9.2fx\n", (unsigned long) n, loop_ns,
+              batch_ns, loop_ns / batch_ns);
+      hashmap_free (&hash_map);
+    }
+  free (keys);
+  return EXIT_SUCCESS;
+}
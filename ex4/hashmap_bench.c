@@ -0,0 +1,454 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "hashmap.h"
+#include "oa_hashmap.h"
+#include "compact_hashmap.h"
+#include "swiss_hashmap.h"
+#include "test_pairs.h"
+#include "hash_funcs.h"
+#include "bench_utils.h"
+
+/*
+ * Measures every hash map engine on the same workloads - insert, lookup of
+ * present keys, lookup of missing keys, apply_if, a mixed workload (half
+ * lookups, a quarter inserts, a quarter erases) and erase - over map sizes
+ * from 16 keys up to max_keys: the average ns per operation, the p50 / p99
+ * latency of a sample of the operations, and the peak RSS. Every engine and
+ * size runs in its own process, so that the peak RSS is its own.
+ * usage: hashmap_bench [max_keys] [engine]
+ */
+
+#define BENCH_DEFAULT_MAX_KEYS 10000000UL
+#define BENCH_MIN_OPS (1UL << 18) // small maps are rebuilt until reached
+#define BENCH_SAMPLES 4096 // latencies sampled per operation kind
+#define BENCH_N_OPS 6
+
+static const char *bench_op_names[BENCH_N_OPS] = {
+    "insert", "lookup hit", "lookup miss", "apply_if", "mixed", "erase"
+};
+
+/**
+ * @struct bench_engine
+ * A hash map engine, behind the same operations.
+ */
+typedef struct bench_engine {
+    const char *name;
+    void *(*alloc) (hash_func func);
+    void (*free) (void *map);
+    int (*insert) (void *map, const pair *in_pair);
+    valueT (*at) (const void *map, const_keyT key);
+    int (*erase) (void *map, const_keyT key);
+    int (*apply_if) (const void *map, keyT_func keyT_func,
+                     valueT_func valT_func);
+} bench_engine;
+
+/**
+ * @struct bench_stat
+ * The measurements of a single kind of operation.
+ */
+typedef struct bench_stat {
+    double total_ns;
+    size_t ops;
+    double samples[BENCH_SAMPLES];
+    size_t n_samples;
+    size_t seen;
+} bench_stat;
+
+static void *chained_alloc (hash_func func)
+{
+  return hashmap_alloc (func);
+}
+static void chained_free (void *map)
+{
+  hashmap_free ((hashmap **) &map);
+}
+static int chained_insert (void *map, const pair *in_pair)
+{
+  return hashmap_insert (map, in_pair);
+}
+static valueT chained_at (const void *map, const_keyT key)
+{
+  return hashmap_at (map, key);
+}
+static int chained_erase (void *map, const_keyT key)
+{
+  return hashmap_erase (map, key);
+}
+static int chained_apply_if (const void *map, keyT_func keyT_func,
+                             valueT_func valT_func)
+{
+  return hashmap_apply_if (map, keyT_func, valT_func);
+}
+
+static void *oa_alloc (hash_func func)
+{
+  return oa_hashmap_alloc (func);
+}
+static void oa_free (void *map)
+{
+  oa_hashmap_free ((oa_hashmap **) &map);
+}
+static int oa_insert (void *map, const pair *in_pair)
+{
+  return oa_hashmap_insert (map, in_pair);
+}
+static valueT oa_at (const void *map, const_keyT key)
+{
+  return oa_hashmap_at (map, key);
+}
+static int oa_erase (void *map, const_keyT key)
+{
+  return oa_hashmap_erase (map, key);
+}
+static int oa_apply_if (const void *map, keyT_func keyT_func,
+                        valueT_func valT_func)
+{
+  return oa_hashmap_apply_if (map, keyT_func, valT_func);
+}
+
+static void *compact_alloc (hash_func func)
+{
+  return compact_hashmap_alloc (func);
+}
+static void compact_free (void *map)
+{
+  compact_hashmap_free ((compact_hashmap **) &map);
+}
+static int compact_insert (void *map, const pair *in_pair)
+{
+  return compact_hashmap_insert (map, in_pair);
+}
+static valueT compact_at (const void *map, const_keyT key)
+{
+  return compact_hashmap_at (map, key);
+}
+static int compact_erase (void *map, const_keyT key)
+{
+  return compact_hashmap_erase (map, key);
+}
+static int compact_apply_if (const void *map, keyT_func keyT_func,
+                             valueT_func valT_func)
+{
+  return compact_hashmap_apply_if (map, keyT_func, valT_func);
+}
+
+static void *swiss_alloc (hash_func func)
+{
+  return swiss_hashmap_alloc (func);
+}
+static void swiss_free (void *map)
+{
+  swiss_hashmap_free ((swiss_hashmap **) &map);
+}
+static int swiss_insert (void *map, const pair *in_pair)
+{
+  return swiss_hashmap_insert (map, in_pair);
+}
+static valueT swiss_at (const void *map, const_keyT key)
+{
+  return swiss_hashmap_at (map, key);
+}
+static int swiss_erase (void *map, const_keyT key)
+{
+  return swiss_hashmap_erase (map, key);
+}
+static int swiss_apply_if (const void *map, keyT_func keyT_func,
+                           valueT_func valT_func)
+{
+  return swiss_hashmap_apply_if (map, keyT_func, valT_func);
+}
+
+static const bench_engine bench_engines[] = {
+    {"chained", chained_alloc, chained_free, chained_insert, chained_at,
+     chained_erase, chained_apply_if},
+    {"oa", oa_alloc, oa_free, oa_insert, oa_at, oa_erase, oa_apply_if},
+    {"compact", compact_alloc, compact_free, compact_insert, compact_at,
+     compact_erase, compact_apply_if},
+    {"swiss", swiss_alloc, swiss_free, swiss_insert, swiss_at, swiss_erase,
+     swiss_apply_if},
+};
+
+#define BENCH_N_ENGINES (sizeof (bench_engines) / sizeof (bench_engines[0]))
+
+/**
+ * @return the i-th key - distinct for every i below 2^32, and scattered
+ */
+static int bench_key (size_t i)
+{
+  return (int) (unsigned) (i * 2654435761UL);
+}
+
+/**
+ * adds a measured run of ops operations to a stat
+ */
+static void stat_add (bench_stat *stat, double ns, size_t ops)
+{
+  stat->total_ns += ns;
+  stat->ops += ops;
+}
+
+/**
+ * counts an operation of a stat
+ * @return 1 if it is to be timed on its own (every stride-th one)
+ */
+static int stat_due (bench_stat *stat, size_t stride)
+{
+  return stat->seen++ % stride == 0;
+}
+
+/**
+ * records the latency of a single sampled operation
+ */
+static void stat_sample (bench_stat *stat, double ns)
+{
+  if (stat->n_samples < BENCH_SAMPLES)
+    {
+      stat->samples[stat->n_samples++] = ns;
+    }
+}
+
+static int compare_doubles (const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @return the p-th percentile of a stat's samples (they are sorted)
+ */
+static double stat_percentile (bench_stat *stat, double p)
+{
+  if (stat->n_samples == 0)
+    {
+      return 0;
+    }
+  qsort (stat->samples, stat->n_samples, sizeof (double), compare_doubles);
+  return stat->samples[(size_t) (p * (double) (stat->n_samples - 1))];
+}
+
+/**
+ * sets the key of the scratch pair (the maps copy it on insert)
+ */
+static const pair *bench_pair (pair *scratch, int key)
+{
+  *(int *) scratch->key = key;
+  return scratch;
+}
+
+/**
+ * the i-th operation of the mixed workload: a quarter inserts of new keys,
+ * a quarter erases of the oldest keys, the rest lookups of present keys
+ * @return 1 if the operation did what was expected, 0 otherwise
+ */
+static int mixed_op (const bench_engine *engine, void *map, size_t n,
+                     size_t i, pair *scratch, size_t *p_inserted,
+                     size_t *p_erased, unsigned long long *state)
+{
+  int key;
+  if (i % 4 == 2)
+    {
+      return engine->insert (map, bench_pair (scratch,
+                                              bench_key (n + (*p_inserted)++)));
+    }
+  if (i % 4 == 3)
+    {
+      key = bench_key ((*p_erased)++);
+      return engine->erase (map, &key);
+    }
+  key = bench_key (*p_erased + bench_rand (state)
+                               % (n + *p_inserted - *p_erased));
+  return engine->at (map, &key) != NULL;
+}
+
+/**
+ * runs one round of every workload on a fresh map of n keys
+ * @param stride every stride-th operation is timed on its own
+ * @return 1 if successful, 0 if the engine failed
+ */
+static int bench_round (const bench_engine *engine, size_t n, size_t stride,
+                        pair *scratch, bench_stat *stats,
+                        unsigned long long *state)
+{
+  void *map = engine->alloc (hash_int);
+  if (map == NULL)
+    {
+      return 0;
+    }
+  double start, op_start;
+  int key, ok = 1;
+  size_t i;
+  // insert
+  start = bench_now_ns ();
+  for (i = 0; i < n; ++i)
+    {
+      if (stat_due (&stats[0], stride))
+        {
+          op_start = bench_now_ns ();
+          ok &= engine->insert (map, bench_pair (scratch, bench_key (i)));
+          stat_sample (&stats[0], bench_now_ns () - op_start);
+          continue;
+        }
+      ok &= engine->insert (map, bench_pair (scratch, bench_key (i)));
+    }
+  stat_add (&stats[0], bench_now_ns () - start, n);
+  // lookups of present, then missing keys
+  for (int miss = 0; miss <= 1; ++miss)
+    {
+      size_t offset = miss ? n : 0;
+      start = bench_now_ns ();
+      for (i = 0; i < n; ++i)
+        {
+          key = bench_key (offset + bench_rand (state) % n);
+          if (stat_due (&stats[1 + miss], stride))
+            {
+              op_start = bench_now_ns ();
+              ok &= (engine->at (map, &key) == NULL) == miss;
+              stat_sample (&stats[1 + miss], bench_now_ns () - op_start);
+              continue;
+            }
+          ok &= (engine->at (map, &key) == NULL) == miss;
+        }
+      stat_add (&stats[1 + miss], bench_now_ns () - start, n);
+    }
+  // apply_if - a single pass, per pair
+  start = bench_now_ns ();
+  engine->apply_if (map, is_even, double_value);
+  double elapsed = bench_now_ns () - start;
+  stat_add (&stats[3], elapsed, n);
+  stat_sample (&stats[3], elapsed / (double) n);
+  // mixed - the keys in [erased, n + inserted) are in the map
+  size_t inserted = 0, erased = 0;
+  start = bench_now_ns ();
+  for (i = 0; i < n; ++i)
+    {
+      if (stat_due (&stats[4], stride))
+        {
+          op_start = bench_now_ns ();
+          ok &= mixed_op (engine, map, n, i, scratch, &inserted, &erased,
+                          state);
+          stat_sample (&stats[4], bench_now_ns () - op_start);
+          continue;
+        }
+      ok &= mixed_op (engine, map, n, i, scratch, &inserted, &erased, state);
+    }
+  stat_add (&stats[4], bench_now_ns () - start, n);
+  // erase
+  start = bench_now_ns ();
+  for (i = erased; i < n + inserted; ++i)
+    {
+      key = bench_key (i);
+      if (stat_due (&stats[5], stride))
+        {
+          op_start = bench_now_ns ();
+          ok &= engine->erase (map, &key);
+          stat_sample (&stats[5], bench_now_ns () - op_start);
+          continue;
+        }
+      ok &= engine->erase (map, &key);
+    }
+  stat_add (&stats[5], bench_now_ns () - start, n + inserted - erased);
+  engine->free (map);
+  return ok;
+}
+
+/**
+ * runs every workload of an engine on maps of n keys, and prints the results
+ * @return 1 if successful, 0 otherwise
+ */
+static int bench_run (const bench_engine *engine, size_t n)
+{
+  int zero = 0;
+  pair *scratch = pair_alloc (&zero, &zero, int_value_cpy, int_value_cpy,
+                              int_value_cmp, int_value_cmp,
+                              int_value_free, int_value_free);
+  bench_stat *stats = (bench_stat *) calloc (BENCH_N_OPS,
+                                             sizeof (bench_stat));
+  if (scratch == NULL || stats == NULL)
+    {
+      void *temp = scratch;
+      pair_free (&temp);
+      free (stats);
+      return 0;
+    }
+  size_t rounds = (BENCH_MIN_OPS + n - 1) / n;
+  size_t stride = rounds * n / BENCH_SAMPLES + 1;
+  unsigned long long state = 88172645463325252ULL;
+  int ok = 1;
+  for (size_t r = 0; r < rounds && ok; ++r)
+    {
+      ok = bench_round (engine, n, stride, scratch, stats, &state);
+    }
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  for (int op = 0; op < BENCH_N_OPS && ok; ++op)
+    {
+      printf ("%-8s %10lu %-12s %10.2f %10.1f %10.1f %12.1f\n", engine->name,
+              (unsigned long) n, bench_op_names[op],
+              stats[op].total_ns / (double) stats[op].ops,
+              stat_percentile (&stats[op], 0.5),
+              stat_percentile (&stats[op], 0.99),
+              (double) usage.ru_maxrss / 1024); // kilobytes on Linux
+    }
+  if (!ok)
+    {
+      fprintf (stderr, "%s: failed at %lu keys\n", engine->name,
+               (unsigned long) n);
+    }
+  void *temp = scratch;
+  pair_free (&temp);
+  free (stats);
+  return ok;
+}
+
+int main (int argc, char *argv[])
+{
+  size_t max_keys = argc > 1 ? strtoul (argv[1], NULL, 10)
+                             : BENCH_DEFAULT_MAX_KEYS;
+  if (max_keys == 0)
+    {
+      max_keys = BENCH_DEFAULT_MAX_KEYS;
+    }
+  const char *only = argc > 2 ? argv[2] : NULL;
+  printf ("%-8s %10s %-12s %10s %10s %10s %12s\n", "engine", "keys", "op",
+          "ns/op", "p50 ns", "p99 ns", "peak RSS MB");
+  int result = EXIT_SUCCESS, ran = 0;
+  for (size_t e = 0; e < BENCH_N_ENGINES; ++e)
+    {
+      if (only != NULL && strcmp (only, bench_engines[e].name) != 0)
+        {
+          continue;
+        }
+      ran = 1;
+      for (size_t n = 16; n <= max_keys; n = n * 16 > max_keys && n < max_keys
+                                              ? max_keys : n * 16)
+        {
+          fflush (stdout);
+          pid_t pid = fork ();
+          if (pid == -1)
+            {
+              return EXIT_FAILURE;
+            }
+          if (pid == 0)
+            {
+              exit (bench_run (&bench_engines[e], n) ? EXIT_SUCCESS
+                                                     : EXIT_FAILURE);
+            }
+          int status;
+          if (waitpid (pid, &status, 0) == -1 || !WIFEXITED (status)
+              || WEXITSTATUS (status) != EXIT_SUCCESS)
+            {
+              result = EXIT_FAILURE;
+            }
+        }
+    }
+  if (!ran)
+    {
+      fprintf (stderr, "unknown engine %s\n", only);
+      return EXIT_FAILURE;
+    }
+  return result;
+}
@@ -0,0 +1,210 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hashmap_mmap.h"
+
+/**
+ * @def SLOT_USED
+ * The offset of the used flag in a slot.
+ */
+#define SLOT_USED 0
+
+/**
+ * @def SLOT_HASH
+ * The offset of the key's hash in a slot.
+ */
+#define SLOT_HASH 8
+
+/**
+ * @def SLOT_KEY
+ * The offset of the key in a slot, the value follows it at value_offset.
+ */
+#define SLOT_KEY 16
+
+/**
+ * rounds size up to a multiple of HASH_MAP_MMAP_ALIGN
+ */
+static uint64_t align_up (uint64_t size)
+{
+  return (size + HASH_MAP_MMAP_ALIGN - 1) / HASH_MAP_MMAP_ALIGN
+         * HASH_MAP_MMAP_ALIGN;
+}
+
+/**
+ * @return the slot at ind of a slot table
+ */
+static unsigned char *slot_at (const unsigned char *slots, size_t slot_size,
+                               size_t ind)
+{
+  return (unsigned char *) slots + ind * slot_size;
+}
+
+/**
+ * reads a uint64_t field of a slot
+ */
+static uint64_t slot_field (const unsigned char *slot, size_t offset)
+{
+  uint64_t field;
+  memcpy (&field, slot + offset, sizeof (uint64_t));
+  return field;
+}
+
+int hashmap_save (const hashmap *hash_map, const char *path,
+                  size_t key_size, size_t value_size)
+{
+  if (hash_map == NULL || path == NULL || key_size == 0 || value_size == 0)
+    {
+      return 0;
+    }
+  hashmap_mmap_header header;
+  header.magic = HASH_MAP_MMAP_MAGIC;
+  header.key_size = key_size;
+  header.value_size = value_size;
+  // the value is aligned, so that a returned value can be dereferenced
+  header.value_offset = SLOT_KEY + align_up (key_size);
+  header.slot_size = align_up (header.value_offset + value_size);
+  header.size = hash_map->size;
+  header.capacity = 1;
+  while ((double) header.size / header.capacity
+         > HASH_MAP_MMAP_MAX_LOAD_FACTOR)
+    {
+      header.capacity *= 2;
+    }
+  unsigned char *slots = (unsigned char *) calloc (header.capacity,
+                                                   header.slot_size);
+  if (slots == NULL)
+    {
+      return 0;
+    }
+  hashmap_iter it;
+  const hashmap_entry *entry;
+  unsigned char *slot;
+  uint64_t used = 1, hash;
+  size_t mask = header.capacity - 1, ind;
+  for (int more = hashmap_iter_begin (hash_map, &it); more;
+       more = hashmap_iter_next (&it))
+    {
+      entry = it.entry;
+      for (ind = entry->hash & mask;
+           slot_field (slot_at (slots, header.slot_size, ind), SLOT_USED);
+           ind = (ind + 1) & mask)
+        {
+        }
+      slot = slot_at (slots, header.slot_size, ind);
+      hash = entry->hash;
+      memcpy (slot + SLOT_USED, &used, sizeof (uint64_t));
+      memcpy (slot + SLOT_HASH, &hash, sizeof (uint64_t));
+      memcpy (slot + SLOT_KEY, entry->pair.key, key_size);
+      memcpy (slot + header.value_offset, entry->pair.value, value_size);
+    }
+  FILE *file = fopen (path, "wb");
+  int result = file != NULL
+               && fwrite (&header, sizeof (header), 1, file) == 1
+               && fwrite (slots, header.slot_size, header.capacity, file)
+                  == header.capacity;
+  if (file != NULL && fclose (file) != 0)
+    {
+      result = 0;
+    }
+  free (slots);
+  return result;
+}
+
+hashmap_mmap *hashmap_open_mmap (const char *path, hash_func func)
+{
+  if (path == NULL || func == NULL)
+    {
+      return NULL;
+    }
+  int fd = open (path, O_RDONLY);
+  if (fd == -1)
+    {
+      return NULL;
+    }
+  struct stat file_stat;
+  if (fstat (fd, &file_stat) != 0
+      || (size_t) file_stat.st_size < sizeof (hashmap_mmap_header))
+    {
+      close (fd);
+      return NULL;
+    }
+  size_t length = (size_t) file_stat.st_size;
+  void *mapped = mmap (NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd); // the mapping stays valid
+  if (mapped == MAP_FAILED)
+    {
+      return NULL;
+    }
+  const hashmap_mmap_header *header = (const hashmap_mmap_header *) mapped;
+  if (header->magic != HASH_MAP_MMAP_MAGIC || header->capacity == 0
+      || (header->capacity & (header->capacity - 1)) != 0
+      || header->size >= header->capacity
+      || header->key_size == 0 || header->value_size == 0
+      // bounded first, so that the offsets below cannot wrap around
+      || header->key_size > length || header->value_size > length
+      || header->value_offset != SLOT_KEY + align_up (header->key_size)
+      || header->slot_size != align_up (header->value_offset
+                                        + header->value_size)
+      || (length - sizeof (hashmap_mmap_header)) / header->slot_size
+         < header->capacity)
+    {
+      munmap (mapped, length);
+      return NULL;
+    }
+  hashmap_mmap *new_map = (hashmap_mmap *) malloc (sizeof (hashmap_mmap));
+  if (new_map == NULL)
+    {
+      munmap (mapped, length);
+      return NULL;
+    }
+  new_map->header = header;
+  new_map->length = length;
+  new_map->hash_func = func;
+  return new_map;
+}
+
+void hashmap_mmap_close (hashmap_mmap **p_hash_map)
+{
+  if (p_hash_map == NULL || *p_hash_map == NULL)
+    {
+      return;
+    }
+  munmap ((void *) (*p_hash_map)->header, (*p_hash_map)->length);
+  free (*p_hash_map);
+  *p_hash_map = NULL;
+}
+
+const_valueT hashmap_mmap_at (const hashmap_mmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return NULL;
+    }
+  const hashmap_mmap_header *header = hash_map->header;
+  const unsigned char *slots = (const unsigned char *) (header + 1);
+  uint64_t hash = hash_map->hash_func (key);
+  size_t mask = header->capacity - 1;
+  const unsigned char *slot;
+  // the table is never full (load <= 0.5), so an empty slot ends the
+  // probe - the bound only guards against a damaged file
+  size_t ind = hash & mask;
+  for (uint64_t step = 0; step < header->capacity;
+       ++step, ind = (ind + 1) & mask)
+    {
+      slot = slot_at (slots, header->slot_size, ind);
+      if (slot_field (slot, SLOT_USED) == 0)
+        {
+          return NULL;
+        }
+      if (slot_field (slot, SLOT_HASH) == hash
+          && memcmp (slot + SLOT_KEY, key, header->key_size) == 0)
+        {
+          return slot + header->value_offset;
+        }
+    }
+  return NULL;
+}
@@ -0,0 +1,107 @@
+#ifndef HASHMAP_MMAP_H_
+#define HASHMAP_MMAP_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "hashmap.h"
+
+/**
+ * @def HASH_MAP_MMAP_MAGIC
+ * The first 8 bytes of a snapshot file ("HMAPSNP2" read as a native
+ * integer, so a file of another byte order is rejected too).
+ */
+#define HASH_MAP_MMAP_MAGIC 0x32504E5350414D48ULL
+
+/**
+ * @def HASH_MAP_MMAP_ALIGN
+ * The alignment of the keys and the values inside a snapshot (and of the
+ * slots) - enough for any plain key or value type.
+ */
+#define HASH_MAP_MMAP_ALIGN 8
+
+/**
+ * @def HASH_MAP_MMAP_MAX_LOAD_FACTOR
+ * The maximal load factor of a snapshot's slot table.
+ */
+#define HASH_MAP_MMAP_MAX_LOAD_FACTOR 0.5
+
+/**
+ * @struct hashmap_mmap_header
+ * The header of a snapshot file, followed by capacity slots of slot_size
+ * bytes each. A slot holds (as uint64_t) 1 if it is used and the key's
+ * hash, then the key's key_size bytes and, at value_offset, the value's
+ * value_size bytes (the key, the value and the slot are padded to
+ * HASH_MAP_MMAP_ALIGN bytes). The slots are found by linear probing from
+ * hash & (capacity - 1). Everything is an offset or a size, so the file is
+ * usable wherever it is mapped.
+ * @param magic HASH_MAP_MMAP_MAGIC.
+ * @param key_size the size of every key, in bytes.
+ * @param value_size the size of every value, in bytes.
+ * @param value_offset the offset of the value in a slot, in bytes.
+ * @param slot_size the size of a slot, in bytes.
+ * @param capacity the number of slots (a power of 2).
+ * @param size the number of pairs.
+ */
+typedef struct hashmap_mmap_header {
+    uint64_t magic;
+    uint64_t key_size;
+    uint64_t value_size;
+    uint64_t value_offset;
+    uint64_t slot_size;
+    uint64_t capacity;
+    uint64_t size;
+} hashmap_mmap_header;
+
+/**
+ * @struct hashmap_mmap
+ * A read only hash map served straight out of a mapped snapshot file.
+ * @param header the mapped file (its header, the slots follow it).
+ * @param length the length of the mapping, in bytes.
+ * @param hash_func the function the keys were hashed with when saved.
+ */
+typedef struct hashmap_mmap {
+    const hashmap_mmap_header *header;
+    size_t length;
+    hash_func hash_func;
+} hashmap_mmap;
+
+/**
+ * Writes a snapshot of the hash map to a file. The keys and values must be
+ * plain fixed size data (like int or char) - they are copied byte by byte.
+ * @param hash_map a hash map.
+ * @param path the file to (over)write.
+ * @param key_size the size of every key of the map, in bytes.
+ * @param value_size the size of every value of the map, in bytes.
+ * @return 1 if successful, 0 otherwise.
+ */
+int hashmap_save (const hashmap *hash_map, const char *path,
+                  size_t key_size, size_t value_size);
+
+/**
+ * Maps a snapshot file written by hashmap_save for reading - nothing is
+ * parsed or copied, so it takes the same time for any size of map.
+ * @param path the snapshot file.
+ * @param func the hash func of the saved map (the stored hashes must not
+ * change between processes).
+ * @return pointer to dynamically allocated hashmap_mmap.
+ * @if_fail return NULL (also if the file is not a valid snapshot).
+ */
+hashmap_mmap *hashmap_open_mmap (const char *path, hash_func func);
+
+/**
+ * Unmaps a snapshot and frees its hashmap_mmap.
+ * @param p_hash_map pointer to dynamically allocated pointer to
+ * hashmap_mmap.
+ */
+void hashmap_mmap_close (hashmap_mmap **p_hash_map);
+
+/**
+ * The function returns the value associated with the given key.
+ * @param hash_map a mapped snapshot.
+ * @param key the key to be checked (key_size bytes are compared).
+ * @return the value associated with key if exists (inside the mapping, read
+ * only, valid until the snapshot is closed), NULL otherwise.
+ */
+const_valueT hashmap_mmap_at (const hashmap_mmap *hash_map, const_keyT key);
+
+#endif //HASHMAP_MMAP_H_
@@ -0,0 +1,272 @@
+#include "oa_hashmap.h"
+
+/**
+ * allocates the slot arrays of an open addressing map, all slots empty
+ * @param cap number of slots
+ * @param p_meta out - the metadata array
+ * @param p_entries out - the pairs array
+ * @return 1 if successful, 0 otherwise.
+ */
+static int slots_alloc (size_t cap, oa_slot_meta **p_meta, pair **p_entries)
+{
+  *p_meta = (oa_slot_meta *) calloc (cap, sizeof (oa_slot_meta));
+  if (*p_meta == NULL)
+    {
+      return 0;
+    }
+  *p_entries = (pair *) malloc (sizeof (pair) * cap);
+  if (*p_entries == NULL)
+    {
+      free (*p_meta);
+      *p_meta = NULL;
+      return 0;
+    }
+  return 1;
+}
+
+/**
+ * places an entry (already owned by the map) in the slot arrays,
+ * Robin Hood style - a richer entry (closer to its home) is displaced
+ * by a poorer one and continues probing in its place.
+ * the key must not be in the arrays already and a free slot must exist.
+ */
+static void slot_place (oa_slot_meta *meta, pair *entries, size_t cap,
+                        size_t hash, pair entry)
+{
+  size_t mask = cap - 1;
+  size_t ind = hash & mask;
+  size_t dist = 1;
+  oa_slot_meta m_temp;
+  pair p_temp;
+  while (meta[ind].dist != 0)
+    {
+      if (meta[ind].dist < dist)
+        {
+          m_temp = meta[ind];
+          p_temp = entries[ind];
+          meta[ind].hash = hash;
+          meta[ind].dist = dist;
+          entries[ind] = entry;
+          hash = m_temp.hash;
+          dist = m_temp.dist;
+          entry = p_temp;
+        }
+      ind = (ind + 1) & mask;
+      ++dist;
+    }
+  meta[ind].hash = hash;
+  meta[ind].dist = dist;
+  entries[ind] = entry;
+}
+
+/**
+ * finds the slot of the given key
+ * @return the slot index if found, -1 otherwise
+ */
+static long slot_find (const oa_hashmap *hash_map, const_keyT key, size_t hash)
+{
+  size_t mask = hash_map->capacity - 1;
+  size_t ind = hash & mask;
+  size_t dist = 1;
+  while (hash_map->meta[ind].dist >= dist) // empty (0) also stops here
+    {
+      if (hash_map->meta[ind].hash == hash
+          && hash_map->entries[ind].key_cmp
+                 (key, hash_map->entries[ind].key) == 1)
+        {
+          return (long) ind;
+        }
+      ind = (ind + 1) & mask;
+      ++dist;
+    }
+  return -1;
+}
+
+/**
+ * moves all the entries to new slot arrays of the given capacity,
+ * reusing the cached hashes and the owned key/value copies.
+ * @return 0 if failed (the map is unchanged), 1 if successful
+ */
+static int slots_resize (oa_hashmap *hash_map, size_t new_cap)
+{
+  oa_slot_meta *meta;
+  pair *entries;
+  if (slots_alloc (new_cap, &meta, &entries) == 0)
+    {
+      return 0;
+    }
+  for (size_t i = 0; i < hash_map->capacity; ++i)
+    {
+      if (hash_map->meta[i].dist != 0)
+        {
+          slot_place (meta, entries, new_cap,
+                      hash_map->meta[i].hash, hash_map->entries[i]);
+        }
+    }
+  free (hash_map->meta);
+  free (hash_map->entries);
+  hash_map->meta = meta;
+  hash_map->entries = entries;
+  hash_map->capacity = new_cap;
+  return 1;
+}
+
+oa_hashmap *oa_hashmap_alloc (hash_func func)
+{
+  if (func == NULL)
+    {
+      return NULL;
+    }
+  oa_hashmap *new_hash = (oa_hashmap *) malloc (sizeof (oa_hashmap));
+  if (new_hash == NULL)
+    {
+      return NULL;
+    }
+  if (slots_alloc (OA_HASH_MAP_INITIAL_CAP,
+                   &new_hash->meta, &new_hash->entries) == 0)
+    {
+      free (new_hash);
+      return NULL;
+    }
+  new_hash->hash_func = func;
+  new_hash->capacity = OA_HASH_MAP_INITIAL_CAP;
+  new_hash->size = 0;
+  return new_hash;
+}
+
+void oa_hashmap_free (oa_hashmap **p_hash_map)
+{
+  if (p_hash_map == NULL || *p_hash_map == NULL)
+    {
+      return;
+    }
+  oa_hashmap *hash_map = *p_hash_map;
+  for (size_t i = 0; i < hash_map->capacity; ++i)
+    {
+      if (hash_map->meta[i].dist != 0)
+        {
+          hash_map->entries[i].key_free (&(hash_map->entries[i].key));
+          hash_map->entries[i].value_free (&(hash_map->entries[i].value));
+        }
+    }
+  free (hash_map->meta);
+  free (hash_map->entries);
+  free (hash_map);
+  *p_hash_map = NULL;
+}
+
+int oa_hashmap_insert (oa_hashmap *hash_map, const pair *in_pair)
+{
+  if (hash_map == NULL || in_pair == NULL)
+    {
+      return 0;
+    }
+  size_t hash = hash_map->hash_func (in_pair->key);
+  if (slot_find (hash_map, in_pair->key, hash) != -1)
+    {
+      return 0;
+    }
+  if (oa_hashmap_get_load_factor (hash_map) >= OA_HASH_MAP_MAX_LOAD_FACTOR)
+    {
+      if (slots_resize (hash_map, hash_map->capacity
+                                  * OA_HASH_MAP_GROWTH_FACTOR) == 0)
+        {
+          return 0;
+        }
+    }
+  pair entry = *in_pair;
+  entry.key = in_pair->key_cpy (in_pair->key);
+  if (entry.key == NULL)
+    {
+      return 0;
+    }
+  entry.value = in_pair->value_cpy (in_pair->value);
+  if (entry.value == NULL)
+    {
+      entry.key_free (&entry.key);
+      return 0;
+    }
+  slot_place (hash_map->meta, hash_map->entries, hash_map->capacity,
+              hash, entry);
+  hash_map->size++;
+  return 1;
+}
+
+valueT oa_hashmap_at (const oa_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return NULL;
+    }
+  long ind = slot_find (hash_map, key, hash_map->hash_func (key));
+  if (ind == -1)
+    {
+      return NULL;
+    }
+  return hash_map->entries[ind].value;
+}
+
+int oa_hashmap_erase (oa_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return 0;
+    }
+  long found = slot_find (hash_map, key, hash_map->hash_func (key));
+  if (found == -1)
+    {
+      return 0;
+    }
+  size_t mask = hash_map->capacity - 1;
+  size_t ind = (size_t) found;
+  hash_map->entries[ind].key_free (&(hash_map->entries[ind].key));
+  hash_map->entries[ind].value_free (&(hash_map->entries[ind].value));
+  // backward shift deletion - no tombstones are left behind
+  size_t next = (ind + 1) & mask;
+  while (hash_map->meta[next].dist > 1)
+    {
+      hash_map->meta[ind].hash = hash_map->meta[next].hash;
+      hash_map->meta[ind].dist = hash_map->meta[next].dist - 1;
+      hash_map->entries[ind] = hash_map->entries[next];
+      ind = next;
+      next = (next + 1) & mask;
+    }
+  hash_map->meta[ind].dist = 0;
+  --hash_map->size;
+  if (oa_hashmap_get_load_factor (hash_map) < OA_HASH_MAP_MIN_LOAD_FACTOR
+      && hash_map->capacity > OA_HASH_MAP_MIN_CAP)
+    {
+      // a failed shrink leaves a valid (just sparse) map behind
+      slots_resize (hash_map, hash_map->capacity / OA_HASH_MAP_GROWTH_FACTOR);
+    }
+  return 1;
+}
+
+double oa_hashmap_get_load_factor (const oa_hashmap *hash_map)
+{
+  if (hash_map == NULL || hash_map->capacity == 0)
+    {
+      return -1;
+    }
+  return (double) hash_map->size / hash_map->capacity;
+}
+
+int oa_hashmap_apply_if (const oa_hashmap *hash_map,
+                         keyT_func keyT_func, valueT_func valT_func)
+{
+  if (hash_map == NULL || keyT_func == NULL || valT_func == NULL)
+    {
+      return -1;
+    }
+  int count = 0;
+  for (size_t i = 0; i < hash_map->capacity; ++i)
+    {
+      if (hash_map->meta[i].dist != 0
+          && keyT_func (hash_map->entries[i].key) == 1)
+        {
+          valT_func (hash_map->entries[i].value);
+          ++count;
+        }
+    }
+  return count;
+}
@@ -0,0 +1,133 @@
+#ifndef OA_HASHMAP_H_
+#define OA_HASHMAP_H_
+
+#include <stdlib.h>
+#include "hashmap.h"
+#include "pair.h"
+
+/**
+ * @def OA_HASH_MAP_INITIAL_CAP
+ * The initial capacity of the open addressing hash map.
+ * It means, the initial number of <b> slots </b> the hash map has.
+ */
+#define OA_HASH_MAP_INITIAL_CAP 16UL
+
+/**
+ * @def OA_HASH_MAP_MIN_CAP
+ * The capacity the open addressing hash map never shrinks below.
+ */
+#define OA_HASH_MAP_MIN_CAP 8UL
+
+/**
+ * @def OA_HASH_MAP_GROWTH_FACTOR
+ * The growth factor of the open addressing hash map.
+ */
+#define OA_HASH_MAP_GROWTH_FACTOR 2UL
+
+/**
+ * @def OA_HASH_MAP_MIN_LOAD_FACTOR
+ * The minimal load factor the open addressing hash map can be in,
+ * after an erase that drops below it the map is minimized.
+ */
+#define OA_HASH_MAP_MIN_LOAD_FACTOR 0.25
+
+/**
+ * @def OA_HASH_MAP_MAX_LOAD_FACTOR
+ * The maximal load factor the open addressing hash map can be in,
+ * an insertion at (or above) it extends the map first.
+ */
+#define OA_HASH_MAP_MAX_LOAD_FACTOR 0.75
+
+/**
+ * @struct oa_slot_meta
+ * The probing metadata of a single slot, kept apart from the pairs so that
+ * a probe sequence only walks this (small, contiguous) array.
+ * @param hash the cached full hash of the key stored in the slot.
+ * @param dist the distance of the slot from the key's home slot plus 1,
+ * 0 marks an empty slot.
+ */
+typedef struct oa_slot_meta {
+    size_t hash;
+    size_t dist;
+} oa_slot_meta;
+
+/**
+ * @struct oa_hashmap
+ * A hash map which stores its pairs inline in a flat array and resolves
+ * collisions with Robin Hood linear probing.
+ * @param meta dynamic array of the slots' probing metadata.
+ * @param entries dynamic array of the pairs, entries[i] is valid iff
+ * meta[i].dist != 0. The keys and values are copies the map owns.
+ * @param size the number of elements (pairs) stored in the hash map.
+ * @param capacity the number of slots in the hash map (a power of 2).
+ * @param hash_func a function which "hashes" keys.
+ */
+typedef struct oa_hashmap {
+    oa_slot_meta *meta;
+    pair *entries;
+    size_t size;
+    size_t capacity;
+    hash_func hash_func;
+} oa_hashmap;
+
+/**
+ * Allocates dynamically new open addressing hash map element.
+ * @param func a function which "hashes" keys.
+ * @return pointer to dynamically allocated oa_hashmap.
+ * @if_fail return NULL.
+ */
+oa_hashmap *oa_hashmap_alloc (hash_func func);
+
+/**
+ * Frees a hash map and the elements the hash map itself allocated.
+ * @param p_hash_map pointer to dynamically allocated pointer to oa_hashmap.
+ */
+void oa_hashmap_free (oa_hashmap **p_hash_map);
+
+/**
+ * Inserts a copy of in_pair to the hash map (see hashmap_insert).
+ * @param hash_map the hash map to be inserted with new element.
+ * @param in_pair a in_pair the hash map would contain.
+ * @return returns 1 for successful insertion, 0 otherwise (also if the key
+ * is already in the map).
+ */
+int oa_hashmap_insert (oa_hashmap *hash_map, const pair *in_pair);
+
+/**
+ * The function returns the value associated with the given key.
+ * @param hash_map a hash map.
+ * @param key the key to be checked.
+ * @return the value associated with key if exists, NULL otherwise (the value
+ * itself, not a copy of it).
+ */
+valueT oa_hashmap_at (const oa_hashmap *hash_map, const_keyT key);
+
+/**
+ * The function erases the pair associated with key.
+ * @param hash_map a hash map.
+ * @param key a key of the pair to be erased.
+ * @return 1 if the erasing was done successfully, 0 otherwise. (if key not
+ * in map, considered fail).
+ */
+int oa_hashmap_erase (oa_hashmap *hash_map, const_keyT key);
+
+/**
+ * This function returns the load factor of the hash map.
+ * @param hash_map a hash map.
+ * @return the hash map's load factor, -1 if the function failed.
+ */
+double oa_hashmap_get_load_factor (const oa_hashmap *hash_map);
+
+/**
+ * Applies valT_func on the values whose keys fulfill keyT_func
+ * (see hashmap_apply_if).
+ * @param hash_map a hash map.
+ * @param keyT_func a function that checks a condition on keyT and return 1
+ * if true, 0 else.
+ * @param valT_func a function that modifies valueT, in-place.
+ * @return number of changed values, -1 on bad input.
+ */
+int oa_hashmap_apply_if (const oa_hashmap *hash_map,
+                         keyT_func keyT_func, valueT_func valT_func);
+
+#endif //OA_HASHMAP_H_
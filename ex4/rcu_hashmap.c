@@ -0,0 +1,389 @@
+#define _POSIX_C_SOURCE 200809L
+#include <limits.h>
+#include "rcu_hashmap.h"
+
+/*
+ * Memory ordering: the readers' slot stores and the writers' epoch scans are
+ * sequentially consistent, so either a writer sees a reader's slot, or that
+ * reader's following loads see the writer's earlier unlink. The pointers
+ * readers follow are published with sequentially consistent stores too.
+ */
+#define RCU_LOAD(ptr) __atomic_load_n (ptr, __ATOMIC_SEQ_CST)
+#define RCU_STORE(ptr, val) __atomic_store_n (ptr, val, __ATOMIC_SEQ_CST)
+
+/**
+ * allocates a table of cap empty buckets
+ * @return rcu_table* if successful, NULL otherwise.
+ */
+static rcu_table *table_alloc (size_t cap)
+{
+  rcu_table *table = (rcu_table *) malloc (sizeof (rcu_table));
+  if (table == NULL)
+    {
+      return NULL;
+    }
+  table->buckets = (rcu_node **) calloc (cap, sizeof (rcu_node *));
+  if (table->buckets == NULL)
+    {
+      free (table);
+      return NULL;
+    }
+  table->capacity = cap;
+  return table;
+}
+
+/**
+ * frees a table and its nodes, but not the pairs (they were moved to a new
+ * table). used as an rcu_retired free_func.
+ */
+static void table_free_shallow (void *ptr)
+{
+  rcu_table *table = (rcu_table *) ptr;
+  rcu_node *node, *next;
+  for (size_t i = 0; i < table->capacity; ++i)
+    {
+      for (node = table->buckets[i]; node != NULL; node = next)
+        {
+          next = node->next;
+          free (node);
+        }
+    }
+  free (table->buckets);
+  free (table);
+}
+
+/**
+ * frees a node and its pair. used as an rcu_retired free_func.
+ */
+static void node_free (void *ptr)
+{
+  rcu_node *node = (rcu_node *) ptr;
+  void *p_temp = node->pair;
+  pair_free (&p_temp);
+  free (node);
+}
+
+/**
+ * frees every retired element whose epoch is older than all the active
+ * readers' epochs
+ * @param hash_map a hash map, its write lock held
+ */
+static void reclaim (rcu_hashmap *hash_map)
+{
+  __atomic_fetch_add (&(hash_map->epoch), 1, __ATOMIC_SEQ_CST);
+  unsigned long min_epoch = ULONG_MAX;
+  unsigned long reader_epoch;
+  for (int i = 0; i < RCU_HASHMAP_MAX_READERS; ++i)
+    {
+      reader_epoch = RCU_LOAD (&(hash_map->readers[i].epoch));
+      if (reader_epoch != 0 && reader_epoch < min_epoch)
+        {
+          min_epoch = reader_epoch;
+        }
+    }
+  rcu_retired **p_retired = &(hash_map->retired);
+  rcu_retired *temp;
+  while (*p_retired != NULL)
+    {
+      temp = *p_retired;
+      if (temp->epoch < min_epoch)
+        {
+          *p_retired = temp->next;
+          temp->free_func (temp->ptr);
+          free (temp);
+        }
+      else
+        {
+          p_retired = &(temp->next);
+        }
+    }
+}
+
+/**
+ * hands unlinked memory to the reclamation
+ * @param hash_map a hash map, its write lock held
+ * @return 0 if failed (ptr was not retired), 1 if successful
+ */
+static int retire (rcu_hashmap *hash_map, void *ptr,
+                   void (*free_func) (void *))
+{
+  rcu_retired *new_retired = (rcu_retired *) malloc (sizeof (rcu_retired));
+  if (new_retired == NULL)
+    {
+      return 0;
+    }
+  new_retired->ptr = ptr;
+  new_retired->free_func = free_func;
+  new_retired->epoch = RCU_LOAD (&(hash_map->epoch));
+  new_retired->next = hash_map->retired;
+  hash_map->retired = new_retired;
+  return 1;
+}
+
+/**
+ * finds the link pointing to the node holding key. every link is loaded
+ * once - a writer may store into a link right after it is read, so a
+ * reader must use the node it loaded, not load the link again.
+ * @param p_node out - set to the node holding key (if found)
+ * @return pointer to the link (a bucket head or a node's next) holding the
+ * node, NULL if the key is not in the table
+ */
+static rcu_node **find_link (const rcu_table *table, const_keyT key,
+                             size_t hash, rcu_node **p_node)
+{
+  rcu_node **link = &(table->buckets[hash & (table->capacity - 1)]);
+  rcu_node *node;
+  while ((node = RCU_LOAD (link)) != NULL)
+    {
+      if (node->hash == hash && node->pair->key_cmp (key, node->pair->key) == 1)
+        {
+          *p_node = node;
+          return link;
+        }
+      link = &(node->next);
+    }
+  return NULL;
+}
+
+/**
+ * publishes a copy of the table with new_cap buckets. the nodes are cloned
+ * (the pairs are shared), readers still in the old table keep using it until
+ * it is reclaimed.
+ * @param hash_map a hash map, its write lock held
+ * @return 0 if failed, 1 if successful
+ */
+static int table_resize (rcu_hashmap *hash_map, size_t new_cap)
+{
+  rcu_table *old_table = hash_map->table;
+  rcu_table *new_table = table_alloc (new_cap);
+  if (new_table == NULL)
+    {
+      return 0;
+    }
+  rcu_node *node, *clone;
+  size_t ind;
+  for (size_t i = 0; i < old_table->capacity; ++i)
+    {
+      for (node = old_table->buckets[i]; node != NULL; node = node->next)
+        {
+          clone = (rcu_node *) malloc (sizeof (rcu_node));
+          if (clone == NULL)
+            {
+              table_free_shallow (new_table);
+              return 0;
+            }
+          ind = node->hash & (new_cap - 1);
+          clone->hash = node->hash;
+          clone->pair = node->pair;
+          clone->next = new_table->buckets[ind];
+          new_table->buckets[ind] = clone;
+        }
+    }
+  if (retire (hash_map, old_table, table_free_shallow) == 0)
+    {
+      table_free_shallow (new_table);
+      return 0;
+    }
+  RCU_STORE (&(hash_map->table), new_table);
+  return 1;
+}
+
+rcu_hashmap *rcu_hashmap_alloc (hash_func func)
+{
+  if (func == NULL)
+    {
+      return NULL;
+    }
+  rcu_hashmap *new_hash = (rcu_hashmap *) calloc (1, sizeof (rcu_hashmap));
+  if (new_hash == NULL)
+    {
+      return NULL;
+    }
+  new_hash->table = table_alloc (RCU_HASHMAP_INITIAL_CAP);
+  if (new_hash->table == NULL)
+    {
+      free (new_hash);
+      return NULL;
+    }
+  if (pthread_mutex_init (&(new_hash->write_lock), NULL) != 0)
+    {
+      table_free_shallow (new_hash->table);
+      free (new_hash);
+      return NULL;
+    }
+  new_hash->hash_func = func;
+  new_hash->epoch = 1; // reader epoch 0 means "outside of a read section"
+  return new_hash;
+}
+
+void rcu_hashmap_free (rcu_hashmap **p_hash_map)
+{
+  if (p_hash_map == NULL || *p_hash_map == NULL)
+    {
+      return;
+    }
+  rcu_hashmap *hash_map = *p_hash_map;
+  rcu_retired *temp;
+  while (hash_map->retired != NULL)
+    {
+      temp = hash_map->retired;
+      hash_map->retired = temp->next;
+      temp->free_func (temp->ptr);
+      free (temp);
+    }
+  rcu_node *node;
+  for (size_t i = 0; i < hash_map->table->capacity; ++i)
+    {
+      for (node = hash_map->table->buckets[i]; node != NULL; node = node->next)
+        {
+          void *p_temp = node->pair;
+          pair_free (&p_temp);
+        }
+    }
+  table_free_shallow (hash_map->table);
+  pthread_mutex_destroy (&(hash_map->write_lock));
+  free (hash_map);
+  *p_hash_map = NULL;
+}
+
+int rcu_hashmap_reader_register (rcu_hashmap *hash_map)
+{
+  if (hash_map == NULL)
+    {
+      return -1;
+    }
+  int expected;
+  for (int i = 0; i < RCU_HASHMAP_MAX_READERS; ++i)
+    {
+      expected = 0;
+      if (__atomic_compare_exchange_n (&(hash_map->readers[i].used),
+                                       &expected, 1, 0, __ATOMIC_SEQ_CST,
+                                       __ATOMIC_SEQ_CST))
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+void rcu_hashmap_reader_unregister (rcu_hashmap *hash_map, int reader)
+{
+  if (hash_map == NULL || reader < 0 || reader >= RCU_HASHMAP_MAX_READERS)
+    {
+      return;
+    }
+  RCU_STORE (&(hash_map->readers[reader].epoch), 0);
+  RCU_STORE (&(hash_map->readers[reader].used), 0);
+}
+
+void rcu_hashmap_read_lock (rcu_hashmap *hash_map, int reader)
+{
+  RCU_STORE (&(hash_map->readers[reader].epoch),
+             RCU_LOAD (&(hash_map->epoch)));
+}
+
+void rcu_hashmap_read_unlock (rcu_hashmap *hash_map, int reader)
+{
+  RCU_STORE (&(hash_map->readers[reader].epoch), 0);
+}
+
+valueT rcu_hashmap_at (const rcu_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return NULL;
+    }
+  size_t hash = hash_map->hash_func (key);
+  rcu_node *node;
+  if (find_link (RCU_LOAD (&(hash_map->table)), key, hash, &node) == NULL)
+    {
+      return NULL;
+    }
+  return node->pair->value;
+}
+
+int rcu_hashmap_insert (rcu_hashmap *hash_map, const pair *in_pair)
+{
+  if (hash_map == NULL || in_pair == NULL)
+    {
+      return 0;
+    }
+  size_t hash = hash_map->hash_func (in_pair->key);
+  int result = 0;
+  rcu_node *node;
+  pthread_mutex_lock (&(hash_map->write_lock));
+  if (find_link (hash_map->table, in_pair->key, hash, &node) != NULL)
+    {
+      pthread_mutex_unlock (&(hash_map->write_lock));
+      return 0;
+    }
+  if ((double) hash_map->size / hash_map->table->capacity
+      >= HASH_MAP_MAX_LOAD_FACTOR)
+    {
+      // a failed resize only leaves the map more loaded
+      table_resize (hash_map,
+                    hash_map->table->capacity * HASH_MAP_GROWTH_FACTOR);
+    }
+  node = (rcu_node *) malloc (sizeof (rcu_node));
+  if (node != NULL)
+    {
+      node->pair = pair_copy (in_pair);
+      if (node->pair == NULL)
+        {
+          free (node);
+        }
+      else
+        {
+          rcu_node **head = &(hash_map->table->buckets
+          [hash & (hash_map->table->capacity - 1)]);
+          node->hash = hash;
+          node->next = *head;
+          RCU_STORE (head, node); // the node is complete before it is seen
+          __atomic_add_fetch (&(hash_map->size), 1, __ATOMIC_RELAXED);
+          result = 1;
+        }
+    }
+  reclaim (hash_map);
+  pthread_mutex_unlock (&(hash_map->write_lock));
+  return result;
+}
+
+int rcu_hashmap_erase (rcu_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return 0;
+    }
+  size_t hash = hash_map->hash_func (key);
+  pthread_mutex_lock (&(hash_map->write_lock));
+  rcu_node *node = NULL;
+  rcu_node **link = find_link (hash_map->table, key, hash, &node);
+  // the node is retired before it is unlinked, so a failure changes nothing
+  if (node == NULL || retire (hash_map, node, node_free) == 0)
+    {
+      pthread_mutex_unlock (&(hash_map->write_lock));
+      return 0;
+    }
+  RCU_STORE (link, node->next); // readers on the node still see its next
+  __atomic_sub_fetch (&(hash_map->size), 1, __ATOMIC_RELAXED);
+  if ((double) hash_map->size / hash_map->table->capacity
+      < HASH_MAP_MIN_LOAD_FACTOR
+      && hash_map->table->capacity > RCU_HASHMAP_INITIAL_CAP)
+    {
+      table_resize (hash_map,
+                    hash_map->table->capacity / HASH_MAP_GROWTH_FACTOR);
+    }
+  reclaim (hash_map);
+  pthread_mutex_unlock (&(hash_map->write_lock));
+  return 1;
+}
+
+double rcu_hashmap_get_load_factor (const rcu_hashmap *hash_map)
+{
+  if (hash_map == NULL)
+    {
+      return -1;
+    }
+  const rcu_table *table = RCU_LOAD (&(hash_map->table));
+  return (double) RCU_LOAD (&(hash_map->size)) / table->capacity;
+}
@@ -0,0 +1,188 @@
+#ifndef RCU_HASHMAP_H_
+#define RCU_HASHMAP_H_
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "hashmap.h"
+
+/**
+ * @def RCU_HASHMAP_INITIAL_CAP
+ * The initial (and minimal) number of buckets of the rcu hash map.
+ */
+#define RCU_HASHMAP_INITIAL_CAP 16UL
+
+/**
+ * @def RCU_HASHMAP_MAX_READERS
+ * The maximal number of reader threads registered to a map at once.
+ */
+#define RCU_HASHMAP_MAX_READERS 64
+
+/**
+ * @def RCU_HASHMAP_CACHE_LINE
+ * The size of a cache line - every reader's slot takes a line of its own,
+ * so readers never write to a line another reader uses.
+ */
+#define RCU_HASHMAP_CACHE_LINE 64
+
+/**
+ * @struct rcu_node
+ * A node of a bucket's list. Nodes are never changed after they are
+ * published, except for their next pointer when the following node is
+ * unlinked.
+ * @param hash the result of hash_func on the pair's key.
+ * @param pair the pair, owned by the map.
+ * @param next the next node of the bucket (accessed atomically).
+ */
+typedef struct rcu_node {
+    size_t hash;
+    pair *pair;
+    struct rcu_node *next;
+} rcu_node;
+
+/**
+ * @struct rcu_table
+ * A bucket array, replaced as a whole (with a single atomic swap) on resize.
+ * @param capacity the number of buckets (a power of 2).
+ * @param buckets the heads of the buckets' lists (accessed atomically).
+ */
+typedef struct rcu_table {
+    size_t capacity;
+    rcu_node **buckets;
+} rcu_table;
+
+/**
+ * @struct rcu_reader_slot
+ * @param epoch the global epoch the reader saw when entering its current
+ * read section, 0 while it is outside of one.
+ * @param used 1 if a reader is registered to the slot.
+ */
+typedef struct rcu_reader_slot {
+    unsigned long epoch;
+    int used;
+    char pad[RCU_HASHMAP_CACHE_LINE - sizeof (unsigned long) - sizeof (int)];
+} rcu_reader_slot;
+
+/**
+ * @struct rcu_retired
+ * Memory unlinked by a writer, freed once no reader can still reach it.
+ * @param ptr the memory to be freed.
+ * @param free_func the function freeing ptr.
+ * @param epoch the global epoch when ptr was unlinked.
+ * @param next the next retired element.
+ */
+typedef struct rcu_retired {
+    void *ptr;
+    void (*free_func) (void *);
+    unsigned long epoch;
+    struct rcu_retired *next;
+} rcu_retired;
+
+/**
+ * @struct rcu_hashmap
+ * A hash map whose readers never lock nor write to shared memory other than
+ * their own slot: writers (serialized by a mutex) publish every change with
+ * a single atomic store, and free unlinked memory only after every reader
+ * that could have seen it has left its read section (epoch based
+ * reclamation).
+ * There is no apply_if: values are read without locks, so they must not be
+ * modified in place - replace the pair (erase + insert) instead.
+ * @param table the current bucket array (accessed atomically).
+ * @param size the number of pairs stored in the map.
+ * @param hash_func a function which "hashes" keys.
+ * @param write_lock serializes the writers.
+ * @param epoch the global epoch, advanced by the writers.
+ * @param retired the memory waiting to be freed (writers only).
+ * @param readers the readers' slots.
+ */
+typedef struct rcu_hashmap {
+    rcu_table *table;
+    size_t size;
+    hash_func hash_func;
+    pthread_mutex_t write_lock;
+    unsigned long epoch;
+    rcu_retired *retired;
+    rcu_reader_slot readers[RCU_HASHMAP_MAX_READERS];
+} rcu_hashmap;
+
+/**
+ * Allocates dynamically new rcu hash map element.
+ * @param func a function which "hashes" keys.
+ * @return pointer to dynamically allocated rcu_hashmap.
+ * @if_fail return NULL.
+ */
+rcu_hashmap *rcu_hashmap_alloc (hash_func func);
+
+/**
+ * Frees a hash map and the elements the hash map itself allocated.
+ * Must not be called while other threads still use the map.
+ * @param p_hash_map pointer to dynamically allocated pointer to rcu_hashmap.
+ */
+void rcu_hashmap_free (rcu_hashmap **p_hash_map);
+
+/**
+ * Registers the calling reader thread.
+ * @param hash_map a hash map.
+ * @return the reader's id, to be passed to the read lock functions,
+ * -1 if all RCU_HASHMAP_MAX_READERS slots are taken.
+ */
+int rcu_hashmap_reader_register (rcu_hashmap *hash_map);
+
+/**
+ * Unregisters a reader, it must be outside of a read section.
+ * @param hash_map a hash map.
+ * @param reader the reader's id.
+ */
+void rcu_hashmap_reader_unregister (rcu_hashmap *hash_map, int reader);
+
+/**
+ * Enters a read section. Never blocks.
+ * @param hash_map a hash map.
+ * @param reader the calling reader's id.
+ */
+void rcu_hashmap_read_lock (rcu_hashmap *hash_map, int reader);
+
+/**
+ * Leaves a read section - the values returned inside it may be freed from
+ * now on. Never blocks.
+ * @param hash_map a hash map.
+ * @param reader the calling reader's id.
+ */
+void rcu_hashmap_read_unlock (rcu_hashmap *hash_map, int reader);
+
+/**
+ * The function returns the value associated with the given key. Must be
+ * called inside a read section (by a reader) or by a writer thread.
+ * @param hash_map a hash map.
+ * @param key the key to be checked.
+ * @return the value associated with key if exists, NULL otherwise (the value
+ * itself, valid until the read section ends - it must not be modified).
+ */
+valueT rcu_hashmap_at (const rcu_hashmap *hash_map, const_keyT key);
+
+/**
+ * Inserts a copy of in_pair to the hash map (see hashmap_insert).
+ * Writers are serialized, readers are never blocked.
+ * @param hash_map the hash map to be inserted with new element.
+ * @param in_pair a in_pair the hash map would contain.
+ * @return returns 1 for successful insertion, 0 otherwise.
+ */
+int rcu_hashmap_insert (rcu_hashmap *hash_map, const pair *in_pair);
+
+/**
+ * The function erases the pair associated with key. The pair is freed once
+ * no reader can still be using it.
+ * @param hash_map a hash map.
+ * @param key a key of the pair to be erased.
+ * @return 1 if the erasing was done successfully, 0 otherwise. (if key not
+ * in map, considered fail).
+ */
+int rcu_hashmap_erase (rcu_hashmap *hash_map, const_keyT key);
+
+/**
+ * This function returns the load factor of the hash map.
+ * @param hash_map a hash map.
+ * @return the hash map's load factor, -1 if the function failed.
+ */
+double rcu_hashmap_get_load_factor (const rcu_hashmap *hash_map);
+
+#endif //RCU_HASHMAP_H_
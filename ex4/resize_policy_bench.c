@@ -0,0 +1,122 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include "hashmap.h"
+#include "test_pairs.h"
+#include "hash_funcs.h"
+#include "bench_utils.h"
+
+/*
+ * Measures a workload oscillating around a resize threshold (a table of
+ * sessions: a steady base of keys, and bursts of keys coming and going)
+ * under several resize policies - the number of resizes and the cost per
+ * operation.
+ * usage: resize_policy_bench [cycles]
+ */
+
+#define BENCH_BASE_KEYS 1000
+#define BENCH_BURST_KEYS 3000
+#define BENCH_DEFAULT_CYCLES 200UL
+
+static pair *bench_pairs[BENCH_BASE_KEYS + BENCH_BURST_KEYS];
+
+/**
+ * counts a resize if the capacity changed since the last call
+ */
+static void count_resize (const hashmap *hash_map, size_t *p_cap,
+                          size_t *p_resizes)
+{
+  if (hash_map->capacity != *p_cap)
+    {
+      *p_cap = hash_map->capacity;
+      ++*p_resizes;
+    }
+}
+
+/**
+ * runs the oscillating workload on a map with the given policy and prints
+ * the results
+ */
+static void bench_policy (const char *name,
+                          const hashmap_resize_policy *policy, size_t cycles)
+{
+  hashmap *hash_map = hashmap_alloc (hash_int);
+  if (hash_map == NULL || hashmap_set_resize_policy (hash_map, policy) == 0)
+    {
+      fprintf (stderr, "%s: bad policy\n", name);
+      hashmap_free (&hash_map);
+      return;
+    }
+  for (int i = 0; i < BENCH_BASE_KEYS; ++i)
+    {
+      hashmap_insert (hash_map, bench_pairs[i]);
+    }
+  size_t cap = hash_map->capacity;
+  size_t resizes = 0, max_cap = cap;
+  double start = bench_now_ns ();
+  for (size_t c = 0; c < cycles; ++c)
+    {
+      for (int i = BENCH_BASE_KEYS; i < BENCH_BASE_KEYS + BENCH_BURST_KEYS;
+           ++i)
+        {
+          hashmap_insert (hash_map, bench_pairs[i]);
+          count_resize (hash_map, &cap, &resizes);
+        }
+      max_cap = cap > max_cap ? cap : max_cap;
+      for (int i = BENCH_BASE_KEYS; i < BENCH_BASE_KEYS + BENCH_BURST_KEYS;
+           ++i)
+        {
+          hashmap_erase (hash_map, bench_pairs[i]->key);
+          count_resize (hash_map, &cap, &resizes);
+        }
+    }
+  double elapsed = bench_now_ns () - start;
+  printf ("%-22s %14.2f %10.2f %10lu %10lu\n", name,
+          (double) resizes / cycles,
+          elapsed / ((double) cycles * 2 * BENCH_BURST_KEYS),
+          (unsigned long) hash_map->capacity, (unsigned long) max_cap);
+  hashmap_free (&hash_map);
+}
+
+int main (int argc, char *argv[])
+{
+  size_t cycles = argc > 1 ? strtoul (argv[1], NULL, 10)
+                           : BENCH_DEFAULT_CYCLES;
+  if (cycles == 0)
+    {
+      cycles = BENCH_DEFAULT_CYCLES;
+    }
+  for (int i = 0; i < BENCH_BASE_KEYS + BENCH_BURST_KEYS; ++i)
+    {
+      bench_pairs[i] = pair_alloc (&i, &i, int_value_cpy, int_value_cpy,
+                                   int_value_cmp, int_value_cmp,
+                                   int_value_free, int_value_free);
+      if (bench_pairs[i] == NULL)
+        {
+          return EXIT_FAILURE;
+        }
+    }
+  printf ("%d base keys, bursts of %d keys, %lu cycles\n", BENCH_BASE_KEYS,
+          BENCH_BURST_KEYS, (unsigned long) cycles);
+  printf ("%-22s %14s %10s %10s %10s\n", "policy", "resizes/cycle",
+          "ns/op", "final cap", "max cap");
+  hashmap_resize_policy policy = hashmap_default_resize_policy ();
+  bench_policy ("default", &policy, cycles);
+  policy.shrink_delay = BENCH_BURST_KEYS;
+  bench_policy ("shrink delay", &policy, cycles);
+  policy = hashmap_default_resize_policy ();
+  policy.min_load_factor = 0.1;
+  bench_policy ("min load 0.1", &policy, cycles);
+  policy = hashmap_default_resize_policy ();
+  policy.shrink_on_demand = 1;
+  bench_policy ("shrink on demand", &policy, cycles);
+  policy = hashmap_default_resize_policy ();
+  policy.growth_factor = 4;
+  policy.min_load_factor = 0.1;
+  bench_policy ("growth 4, min load 0.1", &policy, cycles);
+  for (int i = 0; i < BENCH_BASE_KEYS + BENCH_BURST_KEYS; ++i)
+    {
+      void *temp = bench_pairs[i];
+      pair_free (&temp);
+    }
+  return EXIT_SUCCESS;
+}
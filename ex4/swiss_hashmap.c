@@ -0,0 +1,385 @@
+#include <string.h>
+#include "swiss_hashmap.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * spreads the bits of a hash (hash_func results are often plain integers)
+ * so that both the low 7 bits and the bits choosing the group vary.
+ */
+static uint64_t swiss_mix (size_t hash)
+{
+  uint64_t mixed = (uint64_t) hash * 0x9E3779B97F4A7C15ULL;
+  return mixed ^ (mixed >> 32);
+}
+
+/**
+ * @return the 7 bits of a (mixed) hash kept in the control byte
+ */
+static int8_t swiss_h2 (uint64_t mixed)
+{
+  return (int8_t) (mixed & 0x7F);
+}
+
+/**
+ * @return a bit mask of the slots of the group starting at ctrl whose control
+ * byte equals byte (bit i for slot i)
+ */
+static unsigned group_match (const int8_t *ctrl, int8_t byte)
+{
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128 ((const __m128i *) ctrl);
+  return (unsigned) _mm_movemask_epi8 (_mm_cmpeq_epi8 (group,
+                                                       _mm_set1_epi8 (byte)));
+#else
+  unsigned mask = 0;
+  for (size_t i = 0; i < SWISS_GROUP_WIDTH; ++i)
+    {
+      mask |= (unsigned) (ctrl[i] == byte) << i;
+    }
+  return mask;
+#endif
+}
+
+/**
+ * @return a bit mask of the empty or deleted slots of the group starting at
+ * ctrl (the only control bytes with the sign bit set)
+ */
+static unsigned group_match_free (const int8_t *ctrl)
+{
+#ifdef __SSE2__
+  return (unsigned) _mm_movemask_epi8 (_mm_loadu_si128 ((const __m128i *)
+                                                        ctrl));
+#else
+  unsigned mask = 0;
+  for (size_t i = 0; i < SWISS_GROUP_WIDTH; ++i)
+    {
+      mask |= (unsigned) (ctrl[i] < 0) << i;
+    }
+  return mask;
+#endif
+}
+
+/**
+ * @return the index of the lowest set bit of a non zero mask
+ */
+static unsigned lowest_bit (unsigned mask)
+{
+#ifdef __GNUC__
+  return (unsigned) __builtin_ctz (mask);
+#else
+  unsigned ind = 0;
+  while ((mask & 1) == 0)
+    {
+      mask >>= 1;
+      ++ind;
+    }
+  return ind;
+#endif
+}
+
+/**
+ * @return the first slot of the group a probe for mixed starts at
+ */
+static size_t probe_start (uint64_t mixed, size_t cap)
+{
+  return (size_t) (mixed >> 7) & (cap / SWISS_GROUP_WIDTH - 1);
+}
+
+/**
+ * allocates the slot arrays of a swiss map, all slots empty
+ * @param cap number of slots
+ * @return 1 if successful, 0 otherwise (nothing is allocated).
+ */
+static int slots_alloc (size_t cap, int8_t **p_ctrl, size_t **p_hashes,
+                        pair **p_entries)
+{
+  *p_ctrl = (int8_t *) malloc (cap);
+  *p_hashes = (size_t *) malloc (sizeof (size_t) * cap);
+  *p_entries = (pair *) malloc (sizeof (pair) * cap);
+  if (*p_ctrl == NULL || *p_hashes == NULL || *p_entries == NULL)
+    {
+      free (*p_ctrl);
+      free (*p_hashes);
+      free (*p_entries);
+      return 0;
+    }
+  memset (*p_ctrl, SWISS_CTRL_EMPTY, cap);
+  return 1;
+}
+
+/**
+ * finds the first empty or deleted slot of a hash's probe sequence. the
+ * group steps grow by one (0, 1, 3, 6, ...), which visits every group of a
+ * power of 2 number of groups.
+ * @return the slot index
+ */
+static size_t slot_find_free (const int8_t *ctrl, size_t cap, uint64_t mixed)
+{
+  size_t group_mask = cap / SWISS_GROUP_WIDTH - 1;
+  size_t group = probe_start (mixed, cap);
+  unsigned mask;
+  for (size_t step = 1;; ++step)
+    {
+      mask = group_match_free (ctrl + group * SWISS_GROUP_WIDTH);
+      if (mask != 0)
+        {
+          return group * SWISS_GROUP_WIDTH + lowest_bit (mask);
+        }
+      group = (group + step) & group_mask;
+    }
+}
+
+/**
+ * finds the slot of the given key. only the slots whose control byte
+ * matches the hash's 7 bits are compared, and the first group holding an
+ * empty slot ends the probe.
+ * @return the slot index if found, -1 otherwise
+ */
+static long slot_find (const swiss_hashmap *hash_map, const_keyT key,
+                       size_t hash)
+{
+  uint64_t mixed = swiss_mix (hash);
+  int8_t h2 = swiss_h2 (mixed);
+  size_t group_mask = hash_map->capacity / SWISS_GROUP_WIDTH - 1;
+  size_t group = probe_start (mixed, hash_map->capacity);
+  const int8_t *ctrl;
+  unsigned mask;
+  size_t ind;
+  for (size_t step = 1;; ++step)
+    {
+      ctrl = hash_map->ctrl + group * SWISS_GROUP_WIDTH;
+      for (mask = group_match (ctrl, h2); mask != 0; mask &= mask - 1)
+        {
+          ind = group * SWISS_GROUP_WIDTH + lowest_bit (mask);
+          if (hash_map->hashes[ind] == hash
+              && hash_map->entries[ind].key_cmp
+                     (key, hash_map->entries[ind].key) == 1)
+            {
+              return (long) ind;
+            }
+        }
+      if (group_match (ctrl, SWISS_CTRL_EMPTY) != 0)
+        {
+          return -1;
+        }
+      group = (group + step) & group_mask;
+    }
+}
+
+/**
+ * moves all the entries to new slot arrays of the given capacity (dropping
+ * the deleted markers), reusing the cached hashes and the owned key/value
+ * copies.
+ * @return 0 if failed (the map is unchanged), 1 if successful
+ */
+static int slots_resize (swiss_hashmap *hash_map, size_t new_cap)
+{
+  int8_t *ctrl;
+  size_t *hashes;
+  pair *entries;
+  if (slots_alloc (new_cap, &ctrl, &hashes, &entries) == 0)
+    {
+      return 0;
+    }
+  uint64_t mixed;
+  size_t ind;
+  for (size_t i = 0; i < hash_map->capacity; ++i)
+    {
+      if (hash_map->ctrl[i] >= 0)
+        {
+          mixed = swiss_mix (hash_map->hashes[i]);
+          ind = slot_find_free (ctrl, new_cap, mixed);
+          ctrl[ind] = swiss_h2 (mixed);
+          hashes[ind] = hash_map->hashes[i];
+          entries[ind] = hash_map->entries[i];
+        }
+    }
+  free (hash_map->ctrl);
+  free (hash_map->hashes);
+  free (hash_map->entries);
+  hash_map->ctrl = ctrl;
+  hash_map->hashes = hashes;
+  hash_map->entries = entries;
+  hash_map->capacity = new_cap;
+  hash_map->deleted = 0;
+  return 1;
+}
+
+swiss_hashmap *swiss_hashmap_alloc (hash_func func)
+{
+  if (func == NULL)
+    {
+      return NULL;
+    }
+  swiss_hashmap *new_hash = (swiss_hashmap *) malloc (sizeof (swiss_hashmap));
+  if (new_hash == NULL)
+    {
+      return NULL;
+    }
+  if (slots_alloc (SWISS_HASH_MAP_INITIAL_CAP, &new_hash->ctrl,
+                   &new_hash->hashes, &new_hash->entries) == 0)
+    {
+      free (new_hash);
+      return NULL;
+    }
+  new_hash->hash_func = func;
+  new_hash->capacity = SWISS_HASH_MAP_INITIAL_CAP;
+  new_hash->size = 0;
+  new_hash->deleted = 0;
+  return new_hash;
+}
+
+void swiss_hashmap_free (swiss_hashmap **p_hash_map)
+{
+  if (p_hash_map == NULL || *p_hash_map == NULL)
+    {
+      return;
+    }
+  swiss_hashmap *hash_map = *p_hash_map;
+  for (size_t i = 0; i < hash_map->capacity; ++i)
+    {
+      if (hash_map->ctrl[i] >= 0)
+        {
+          hash_map->entries[i].key_free (&(hash_map->entries[i].key));
+          hash_map->entries[i].value_free (&(hash_map->entries[i].value));
+        }
+    }
+  free (hash_map->ctrl);
+  free (hash_map->hashes);
+  free (hash_map->entries);
+  free (hash_map);
+  *p_hash_map = NULL;
+}
+
+int swiss_hashmap_insert (swiss_hashmap *hash_map, const pair *in_pair)
+{
+  if (hash_map == NULL || in_pair == NULL)
+    {
+      return 0;
+    }
+  size_t hash = hash_map->hash_func (in_pair->key);
+  if (slot_find (hash_map, in_pair->key, hash) != -1)
+    {
+      return 0;
+    }
+  size_t limit = (size_t) ((double) hash_map->capacity
+                           * SWISS_HASH_MAP_MAX_LOAD_FACTOR);
+  if (hash_map->size + hash_map->deleted + 1 > limit)
+    {
+      // mostly deleted markers - clean them up in place instead of growing
+      size_t new_cap = hash_map->size + 1 <= limit / 2
+                       ? hash_map->capacity
+                       : hash_map->capacity * SWISS_HASH_MAP_GROWTH_FACTOR;
+      if (slots_resize (hash_map, new_cap) == 0)
+        {
+          return 0;
+        }
+    }
+  pair entry = *in_pair;
+  entry.key = in_pair->key_cpy (in_pair->key);
+  if (entry.key == NULL)
+    {
+      return 0;
+    }
+  entry.value = in_pair->value_cpy (in_pair->value);
+  if (entry.value == NULL)
+    {
+      entry.key_free (&entry.key);
+      return 0;
+    }
+  uint64_t mixed = swiss_mix (hash);
+  size_t ind = slot_find_free (hash_map->ctrl, hash_map->capacity, mixed);
+  if (hash_map->ctrl[ind] == SWISS_CTRL_DELETED)
+    {
+      --hash_map->deleted;
+    }
+  hash_map->ctrl[ind] = swiss_h2 (mixed);
+  hash_map->hashes[ind] = hash;
+  hash_map->entries[ind] = entry;
+  hash_map->size++;
+  return 1;
+}
+
+valueT swiss_hashmap_at (const swiss_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return NULL;
+    }
+  long ind = slot_find (hash_map, key, hash_map->hash_func (key));
+  if (ind == -1)
+    {
+      return NULL;
+    }
+  return hash_map->entries[ind].value;
+}
+
+int swiss_hashmap_erase (swiss_hashmap *hash_map, const_keyT key)
+{
+  if (hash_map == NULL || key == NULL)
+    {
+      return 0;
+    }
+  long found = slot_find (hash_map, key, hash_map->hash_func (key));
+  if (found == -1)
+    {
+      return 0;
+    }
+  size_t ind = (size_t) found;
+  hash_map->entries[ind].key_free (&(hash_map->entries[ind].key));
+  hash_map->entries[ind].value_free (&(hash_map->entries[ind].value));
+  // a probe never went on past a group holding an empty slot, so the slot
+  // can be emptied if its group has one - otherwise it is marked deleted
+  const int8_t *group = hash_map->ctrl + (ind & ~(SWISS_GROUP_WIDTH - 1));
+  if (group_match (group, SWISS_CTRL_EMPTY) != 0)
+    {
+      hash_map->ctrl[ind] = SWISS_CTRL_EMPTY;
+    }
+  else
+    {
+      hash_map->ctrl[ind] = SWISS_CTRL_DELETED;
+      ++hash_map->deleted;
+    }
+  --hash_map->size;
+  if (swiss_hashmap_get_load_factor (hash_map)
+      < SWISS_HASH_MAP_MIN_LOAD_FACTOR
+      && hash_map->capacity > SWISS_HASH_MAP_MIN_CAP)
+    {
+      // a failed shrink leaves a valid (just sparse) map behind
+      slots_resize (hash_map, hash_map->capacity
+                              / SWISS_HASH_MAP_GROWTH_FACTOR);
+    }
+  return 1;
+}
+
+double swiss_hashmap_get_load_factor (const swiss_hashmap *hash_map)
+{
+  if (hash_map == NULL || hash_map->capacity == 0)
+    {
+      return -1;
+    }
+  return (double) hash_map->size / hash_map->capacity;
+}
+
+int swiss_hashmap_apply_if (const swiss_hashmap *hash_map,
+                            keyT_func keyT_func, valueT_func valT_func)
+{
+  if (hash_map == NULL || keyT_func == NULL || valT_func == NULL)
+    {
+      return -1;
+    }
+  int count = 0;
+  for (size_t i = 0; i < hash_map->capacity; ++i)
+    {
+      if (hash_map->ctrl[i] >= 0
+          && keyT_func (hash_map->entries[i].key) == 1)
+        {
+          valT_func (hash_map->entries[i].value);
+          ++count;
+        }
+    }
+  return count;
+}
@@ -0,0 +1,151 @@
+#ifndef SWISS_HASHMAP_H_
+#define SWISS_HASHMAP_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "hashmap.h"
+#include "pair.h"
+
+/**
+ * @def SWISS_GROUP_WIDTH
+ * The number of slots whose control bytes are probed at once (one SSE2
+ * register).
+ */
+#define SWISS_GROUP_WIDTH 16UL
+
+/**
+ * @def SWISS_HASH_MAP_INITIAL_CAP
+ * The initial capacity of the swiss hash map.
+ * It means, the initial number of <b> slots </b> the hash map has.
+ */
+#define SWISS_HASH_MAP_INITIAL_CAP 16UL
+
+/**
+ * @def SWISS_HASH_MAP_MIN_CAP
+ * The capacity the swiss hash map never shrinks below (a single group).
+ */
+#define SWISS_HASH_MAP_MIN_CAP SWISS_GROUP_WIDTH
+
+/**
+ * @def SWISS_HASH_MAP_GROWTH_FACTOR
+ * The growth factor of the swiss hash map.
+ */
+#define SWISS_HASH_MAP_GROWTH_FACTOR 2UL
+
+/**
+ * @def SWISS_HASH_MAP_MIN_LOAD_FACTOR
+ * The minimal load factor the swiss hash map can be in,
+ * after an erase that drops below it the map is minimized.
+ */
+#define SWISS_HASH_MAP_MIN_LOAD_FACTOR 0.25
+
+/**
+ * @def SWISS_HASH_MAP_MAX_LOAD_FACTOR
+ * The maximal share of the slots in use (by pairs or by deleted markers),
+ * an insertion at (or above) it cleans up or extends the map first.
+ */
+#define SWISS_HASH_MAP_MAX_LOAD_FACTOR 0.875
+
+/**
+ * @def SWISS_CTRL_EMPTY
+ * The control byte of an empty slot.
+ */
+#define SWISS_CTRL_EMPTY ((int8_t) -128)
+
+/**
+ * @def SWISS_CTRL_DELETED
+ * The control byte of an erased slot - a probe goes on past it.
+ */
+#define SWISS_CTRL_DELETED ((int8_t) -2)
+
+/**
+ * @struct swiss_hashmap
+ * A hash map in the style of a "Swiss table": open addressing over groups
+ * of SWISS_GROUP_WIDTH slots, with a control byte per slot holding 7 bits
+ * of the key's hash (or an empty / deleted marker). A lookup compares the
+ * control bytes of a whole group at once (with SSE2 where available), and
+ * calls key_cmp only on the slots whose 7 bits match.
+ * @param ctrl dynamic array of the slots' control bytes, a full slot's byte
+ * is in [0, 127].
+ * @param hashes dynamic array of the full hashes of the keys, hashes[i] is
+ * valid iff slot i is full.
+ * @param entries dynamic array of the pairs, entries[i] is valid iff slot i
+ * is full. The keys and values are copies the map owns.
+ * @param size the number of elements (pairs) stored in the hash map.
+ * @param deleted the number of slots marked deleted.
+ * @param capacity the number of slots in the hash map (a power of 2, at
+ * least a group).
+ * @param hash_func a function which "hashes" keys.
+ */
+typedef struct swiss_hashmap {
+    int8_t *ctrl;
+    size_t *hashes;
+    pair *entries;
+    size_t size;
+    size_t deleted;
+    size_t capacity;
+    hash_func hash_func;
+} swiss_hashmap;
+
+/**
+ * Allocates dynamically new swiss hash map element.
+ * @param func a function which "hashes" keys.
+ * @return pointer to dynamically allocated swiss_hashmap.
+ * @if_fail return NULL.
+ */
+swiss_hashmap *swiss_hashmap_alloc (hash_func func);
+
+/**
+ * Frees a hash map and the elements the hash map itself allocated.
+ * @param p_hash_map pointer to dynamically allocated pointer to
+ * swiss_hashmap.
+ */
+void swiss_hashmap_free (swiss_hashmap **p_hash_map);
+
+/**
+ * Inserts a copy of in_pair to the hash map (see hashmap_insert).
+ * @param hash_map the hash map to be inserted with new element.
+ * @param in_pair a in_pair the hash map would contain.
+ * @return returns 1 for successful insertion, 0 otherwise (also if the key
+ * is already in the map).
+ */
+int swiss_hashmap_insert (swiss_hashmap *hash_map, const pair *in_pair);
+
+/**
+ * The function returns the value associated with the given key.
+ * @param hash_map a hash map.
+ * @param key the key to be checked.
+ * @return the value associated with key if exists, NULL otherwise (the value
+ * itself, not a copy of it).
+ */
+valueT swiss_hashmap_at (const swiss_hashmap *hash_map, const_keyT key);
+
+/**
+ * The function erases the pair associated with key.
+ * @param hash_map a hash map.
+ * @param key a key of the pair to be erased.
+ * @return 1 if the erasing was done successfully, 0 otherwise. (if key not
+ * in map, considered fail).
+ */
+int swiss_hashmap_erase (swiss_hashmap *hash_map, const_keyT key);
+
+/**
+ * This function returns the load factor of the hash map.
+ * @param hash_map a hash map.
+ * @return the hash map's load factor, -1 if the function failed.
+ */
+double swiss_hashmap_get_load_factor (const swiss_hashmap *hash_map);
+
+/**
+ * Applies valT_func on the values whose keys fulfill keyT_func
+ * (see hashmap_apply_if).
+ * @param hash_map a hash map.
+ * @param keyT_func a function that checks a condition on keyT and return 1
+ * if true, 0 else.
+ * @param valT_func a function that modifies valueT, in-place.
+ * @return number of changed values, -1 on bad input.
+ */
+int swiss_hashmap_apply_if (const swiss_hashmap *hash_map,
+                            keyT_func keyT_func, valueT_func valT_func);
+
+#endif //SWISS_HASHMAP_H_
@@ -1,6 +1,21 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
 #include "test_suite.h"
 #include "test_pairs.h"
 #include "hash_funcs.h"
+#include "oa_hashmap.h"
+#include "concurrent_hashmap.h"
+#include "rcu_hashmap.h"
+#include "typed_hashmap.h"
+#include "compact_hashmap.h"
+#include "hashmap_mmap.h"
+#include "swiss_hashmap.h"
+
+DECLARE_HASHMAP(int_int_map, int, int, TYPED_HASHMAP_HASH_INTEGRAL,
+                TYPED_HASHMAP_EQ)
+DECLARE_HASHMAP(char_int_map, char, int, TYPED_HASHMAP_HASH_INTEGRAL,
+                TYPED_HASHMAP_EQ)
 
 void *get_new_pair_char_int (char key, int val)
 {
@@ -259,4 +274,1503 @@ void test_hash_map_apply_if ()
   val1 = *((int *) (hashmap_at (hm, &key)));
   assert(val1 == 2 * val2);
   hashmap_free (&hm);
-}
\ No newline at end of file
+}
+/**
+ * This function checks the oa_hashmap (open addressing) engine.
+ * If the oa_hashmap fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_oa_hash_map (void)
+{
+  oa_hashmap *hm = oa_hashmap_alloc (hash_int);
+  void *my_pair;
+  int key;
+  // multiples of 16 all share a home slot - long probe sequences
+  for (int i = 0; i < 100; ++i)
+    {
+      my_pair = get_new_pair_int_int (i * 16, i);
+      assert(oa_hashmap_insert (hm, my_pair) == 1);
+      assert(oa_hashmap_insert (hm, my_pair) == 0);
+      pair_free (&my_pair);
+    }
+  assert(hm->size == 100);
+  assert(hm->capacity == 256);
+  for (int i = 0; i < 100; ++i)
+    {
+      key = i * 16;
+      assert(*(int *) oa_hashmap_at (hm, &key) == i);
+      key = i * 16 + 1;
+      assert(oa_hashmap_at (hm, &key) == NULL);
+    }
+  assert(oa_hashmap_apply_if (hm, is_even, double_value) == 100);
+  key = 16;
+  assert(*(int *) oa_hashmap_at (hm, &key) == 2);
+  for (int i = 0; i < 100; i += 2)
+    {
+      key = i * 16;
+      assert(oa_hashmap_erase (hm, &key) == 1);
+      assert(oa_hashmap_erase (hm, &key) == 0);
+    }
+  for (int i = 1; i < 100; i += 2)
+    {
+      key = i * 16;
+      assert(*(int *) oa_hashmap_at (hm, &key) == 2 * i);
+    }
+  assert(hm->size == 50);
+  assert(hm->capacity == 128);
+  // Check for bad input:
+  assert(oa_hashmap_insert (hm, NULL) == 0);
+  assert(oa_hashmap_at (hm, NULL) == NULL);
+  assert(oa_hashmap_erase (NULL, &key) == 0);
+  assert(oa_hashmap_get_load_factor (NULL) == -1);
+  oa_hashmap_free (&hm);
+  assert(hm == NULL);
+}
+
+/**
+ * This function checks a hashmap allocated with hashmap_alloc_incremental.
+ * If the incremental hashmap fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_incremental (void)
+{
+  hashmap *hm = hashmap_alloc_incremental (hash_int);
+  void *my_pair;
+  int key;
+  int saw_migration = 0;
+  for (int i = 0; i < 2000; ++i)
+    {
+      my_pair = get_new_pair_int_int (i, i);
+      assert(hashmap_insert (hm, my_pair) == 1);
+      assert(hashmap_insert (hm, my_pair) == 0);
+      pair_free (&my_pair);
+      if (hm->old_buckets != NULL)
+        {
+          saw_migration = 1;
+        }
+      for (int j = 0; j <= i; j += 97) // both arrays are looked up
+        {
+          assert(*(int *) hashmap_at (hm, &j) == j);
+        }
+    }
+  assert(saw_migration == 1);
+  assert(hm->size == 2000);
+  assert(hm->capacity == 4096);
+  assert(hashmap_apply_if (hm, is_even, double_value) == 1000);
+  for (int i = 0; i < 2000; ++i)
+    {
+      assert(hashmap_erase (hm, &i) == 1);
+      key = i + 1;
+      if (key < 2000)
+        {
+          assert(*(int *) hashmap_at (hm, &key) == (key % 2 ? key : 2 * key));
+        }
+    }
+  assert(hm->size == 0);
+  assert(hashmap_at (hm, &key) == NULL);
+  hashmap_free (&hm);
+}
+
+/**
+ * This function checks the lazy allocation of the hashmap's buckets.
+ * If the buckets fail at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_lazy_buckets (void)
+{
+  hashmap *hm = hashmap_alloc (hash_int);
+  void *my_pair;
+  int keys[3] = {5, 5 + 16, 5 + 32}; // all land in bucket 5
+  for (size_t i = 0; i < hm->capacity; ++i)
+    {
+      assert(hm->buckets[i].head == NULL && hm->buckets[i].rest == NULL);
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+      my_pair = get_new_pair_int_int (keys[i], i);
+      assert(hashmap_insert (hm, my_pair) == 1);
+      pair_free (&my_pair);
+      assert(hm->buckets[5].head != NULL);
+      assert((hm->buckets[5].rest == NULL) == (i == 0));
+    }
+  // erasing the head moves a colliding pair into its place
+  assert(hashmap_erase (hm, &keys[0]) == 1);
+  assert(*(int *) hashmap_at (hm, &keys[1]) == 1);
+  assert(*(int *) hashmap_at (hm, &keys[2]) == 2);
+  assert(hashmap_erase (hm, &keys[2]) == 1);
+  // the erases shrank the map, keys[1] is alone in its bucket now
+  bucket *buck = &(hm->buckets[keys[1] & (hm->capacity - 1)]);
+  assert(buck->head != NULL && buck->rest == NULL);
+  assert(*(int *) hashmap_at (hm, &keys[1]) == 1);
+  hashmap_free (&hm);
+}
+
+static size_t hash_calls = 0;
+
+/**
+ * hash_int which counts its calls.
+ */
+size_t hash_int_counted (const void *elem)
+{
+  ++hash_calls;
+  return hash_int (elem);
+}
+
+/**
+ * This function checks the hashmap_try_emplace and hashmap_insert_or_assign
+ * functions of the hashmap library.
+ * If they fail at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_try_emplace_insert_or_assign (void)
+{
+  hashmap *hm = hashmap_alloc (hash_int_counted);
+  void *my_pair;
+  int inserted;
+  int key = 7;
+  my_pair = get_new_pair_int_int (key, 70);
+  hash_calls = 0;
+  assert(hashmap_insert (hm, my_pair) == 1);
+  assert(hash_calls == 1);
+  pair_free (&my_pair);
+  // the key is there already - the value is kept
+  my_pair = get_new_pair_int_int (key, 71);
+  assert(*(int *) hashmap_try_emplace (hm, my_pair, &inserted) == 70);
+  assert(inserted == 0);
+  assert(hashmap_insert_or_assign (hm, my_pair) == 1);
+  assert(*(int *) hashmap_at (hm, &key) == 71);
+  assert(hm->size == 1);
+  pair_free (&my_pair);
+  key = 8;
+  my_pair = get_new_pair_int_int (key, 80);
+  assert(*(int *) hashmap_try_emplace (hm, my_pair, &inserted) == 80);
+  assert(inserted == 1);
+  pair_free (&my_pair);
+  key = 9;
+  my_pair = get_new_pair_int_int (key, 90);
+  assert(hashmap_insert_or_assign (hm, my_pair) == 1);
+  assert(*(int *) hashmap_at (hm, &key) == 90);
+  assert(hm->size == 3);
+  for (int i = 10; i < 14; ++i) // above the min load factor - no shrink
+    {
+      void *temp = get_new_pair_int_int (i, i);
+      assert(hashmap_insert (hm, temp) == 1);
+      pair_free (&temp);
+    }
+  hash_calls = 0;
+  assert(hashmap_erase (hm, &key) == 1);
+  assert(hash_calls == 1);
+  // Check for bad input:
+  assert(hashmap_try_emplace (hm, NULL, &inserted) == NULL);
+  assert(hashmap_try_emplace (NULL, my_pair, NULL) == NULL);
+  assert(hashmap_insert_or_assign (hm, NULL) == 0);
+  assert(hashmap_insert_or_assign (NULL, my_pair) == 0);
+  pair_free (&my_pair);
+  hashmap_free (&hm);
+}
+
+/**
+ * This function checks that resizing the hashmap never calls its hash
+ * function.
+ * If the hashmap fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_cached_hash (void)
+{
+  hashmap *hm = hashmap_alloc (hash_int_counted);
+  void *my_pair;
+  hash_calls = 0;
+  for (int i = 0; i < 1000; ++i) // grows 16 -> 2048
+    {
+      my_pair = get_new_pair_int_int (i, i);
+      assert(hashmap_insert (hm, my_pair) == 1);
+      pair_free (&my_pair);
+    }
+  assert(hm->capacity == 2048);
+  assert(hash_calls == 1000);
+  hash_calls = 0;
+  for (int i = 0; i < 1000; ++i) // shrinks back
+    {
+      assert(hashmap_erase (hm, &i) == 1);
+    }
+  assert(hm->capacity < 16);
+  assert(hash_calls == 1000);
+  hashmap_free (&hm);
+}
+
+/**
+ * This function checks the hashmap_reserve and hashmap_insert_bulk functions
+ * of the hashmap library.
+ * If they fail at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_reserve_insert_bulk (void)
+{
+  hashmap *hm = hashmap_alloc (hash_int);
+  const pair *pairs[100];
+  assert(hashmap_reserve (hm, 12) == 1);
+  assert(hm->capacity == HASH_MAP_INITIAL_CAP); // 12 fit already
+  assert(hashmap_reserve (hm, 13) == 1);
+  assert(hm->capacity == 32);
+  assert(hashmap_reserve (hm, 5) == 1); // never minimizes
+  assert(hm->capacity == 32);
+  for (int i = 0; i < 100; ++i)
+    {
+      pairs[i] = get_new_pair_int_int (i % 90, i); // 10 duplicate keys
+    }
+  assert(hashmap_insert_bulk (hm, pairs, 100) == 90);
+  assert(hm->capacity == 256); // reserved for 100 at once
+  assert(hm->size == 90);
+  for (int i = 0; i < 90; ++i)
+    {
+      assert(*(int *) hashmap_at (hm, &i) == i);
+    }
+  // Check for bad input:
+  assert(hashmap_insert_bulk (hm, NULL, 1) == -1);
+  assert(hashmap_insert_bulk (NULL, pairs, 100) == -1);
+  assert(hashmap_reserve (NULL, 1) == 0);
+  for (int i = 0; i < 100; ++i)
+    {
+      void *temp = (void *) pairs[i];
+      pair_free (&temp);
+    }
+  hashmap_free (&hm);
+}
+
+#define CONCURRENT_TEST_THREADS 4
+#define CONCURRENT_TEST_KEYS 1000
+
+/**
+ * @struct concurrent_test_args
+ * @param map the map shared by all the test's threads.
+ * @param index the index of the thread.
+ */
+typedef struct concurrent_test_args {
+    concurrent_hashmap *map;
+    int index;
+} concurrent_test_args;
+
+/**
+ * inserts CONCURRENT_TEST_KEYS keys of its own to the map, erases the odd
+ * ones and reads the rest back
+ * @param arg pointer to the thread's concurrent_test_args
+ */
+void *concurrent_test_worker (void *arg)
+{
+  concurrent_test_args *args = (concurrent_test_args *) arg;
+  int first = args->index * CONCURRENT_TEST_KEYS;
+  void *my_pair;
+  valueT value;
+  for (int key = first; key < first + CONCURRENT_TEST_KEYS; ++key)
+    {
+      my_pair = get_new_pair_int_int (key, -key);
+      assert(concurrent_hashmap_insert (args->map, my_pair) == 1);
+      pair_free (&my_pair);
+    }
+  for (int key = first + 1; key < first + CONCURRENT_TEST_KEYS; key += 2)
+    {
+      assert(concurrent_hashmap_erase (args->map, &key) == 1);
+    }
+  for (int key = first; key < first + CONCURRENT_TEST_KEYS; ++key)
+    {
+      value = concurrent_hashmap_at (args->map, &key);
+      assert((value == NULL) == (key % 2 == 1));
+      assert(value == NULL || *(int *) value == -key);
+      int_value_free (&value);
+    }
+  return NULL;
+}
+
+/**
+ * This function checks the concurrent_hashmap.
+ * If the concurrent_hashmap fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_concurrent_hash_map (void)
+{
+  concurrent_hashmap *hm = concurrent_hashmap_alloc (hash_int, 6);
+  pthread_t threads[CONCURRENT_TEST_THREADS];
+  concurrent_test_args args[CONCURRENT_TEST_THREADS];
+  assert(hm->n_shards == 8); // rounded up to a power of 2
+  for (int i = 0; i < CONCURRENT_TEST_THREADS; ++i)
+    {
+      args[i].map = hm;
+      args[i].index = i;
+      assert(pthread_create (&threads[i], NULL,
+                             concurrent_test_worker, &args[i]) == 0);
+    }
+  for (int i = 0; i < CONCURRENT_TEST_THREADS; ++i)
+    {
+      pthread_join (threads[i], NULL);
+    }
+  assert(concurrent_hashmap_size (hm)
+         == CONCURRENT_TEST_THREADS * CONCURRENT_TEST_KEYS / 2);
+  assert(concurrent_hashmap_apply_if (hm, is_even, negative_value)
+         == CONCURRENT_TEST_THREADS * CONCURRENT_TEST_KEYS / 2);
+  int key = 2;
+  valueT value = concurrent_hashmap_at (hm, &key);
+  assert(*(int *) value == 2);
+  int_value_free (&value);
+  // Check for bad input:
+  assert(concurrent_hashmap_insert (hm, NULL) == 0);
+  assert(concurrent_hashmap_at (hm, NULL) == NULL);
+  assert(concurrent_hashmap_erase (NULL, &key) == 0);
+  assert(concurrent_hashmap_apply_if (hm, NULL, negative_value) == -1);
+  concurrent_hashmap_free (&hm);
+  assert(hm == NULL);
+}
+
+#define RCU_TEST_READERS 3
+#define RCU_TEST_STABLE_KEYS 100
+
+/**
+ * @struct rcu_test_args
+ * @param map the map shared by all the test's threads.
+ * @param done set by the writer once it is done.
+ */
+typedef struct rcu_test_args {
+    rcu_hashmap *map;
+    int done;
+} rcu_test_args;
+
+/**
+ * looks up the stable keys [0, RCU_TEST_STABLE_KEYS) - never erased - until
+ * the writer is done
+ * @param arg pointer to the test's rcu_test_args
+ */
+void *rcu_test_reader (void *arg)
+{
+  rcu_test_args *args = (rcu_test_args *) arg;
+  int reader = rcu_hashmap_reader_register (args->map);
+  assert(reader != -1);
+  while (__atomic_load_n (&(args->done), __ATOMIC_SEQ_CST) == 0)
+    {
+      rcu_hashmap_read_lock (args->map, reader);
+      for (int key = 0; key < RCU_TEST_STABLE_KEYS; ++key)
+        {
+          valueT value = rcu_hashmap_at (args->map, &key);
+          assert(value != NULL && *(int *) value == key);
+        }
+      rcu_hashmap_read_unlock (args->map, reader);
+    }
+  rcu_hashmap_reader_unregister (args->map, reader);
+  return NULL;
+}
+
+/**
+ * looks up the key 0 (mapped to 7, never erased) until the writer is done,
+ * while the writer inserts and erases a key of the same bucket
+ * @param arg pointer to the test's rcu_test_args
+ */
+void *rcu_test_bucket_reader (void *arg)
+{
+  rcu_test_args *args = (rcu_test_args *) arg;
+  int reader = rcu_hashmap_reader_register (args->map);
+  assert(reader != -1);
+  int key = 0;
+  while (__atomic_load_n (&(args->done), __ATOMIC_SEQ_CST) == 0)
+    {
+      rcu_hashmap_read_lock (args->map, reader);
+      valueT value = rcu_hashmap_at (args->map, &key);
+      assert(value != NULL && *(int *) value == 7);
+      rcu_hashmap_read_unlock (args->map, reader);
+    }
+  rcu_hashmap_reader_unregister (args->map, reader);
+  return NULL;
+}
+
+/**
+ * This function checks the rcu_hashmap.
+ * If the rcu_hashmap fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_rcu_hash_map (void)
+{
+  rcu_test_args args = {rcu_hashmap_alloc (hash_int), 0};
+  pthread_t threads[RCU_TEST_READERS];
+  void *my_pair;
+  for (int key = 0; key < RCU_TEST_STABLE_KEYS; ++key)
+    {
+      my_pair = get_new_pair_int_int (key, key);
+      assert(rcu_hashmap_insert (args.map, my_pair) == 1);
+      assert(rcu_hashmap_insert (args.map, my_pair) == 0);
+      pair_free (&my_pair);
+    }
+  for (int i = 0; i < RCU_TEST_READERS; ++i)
+    {
+      assert(pthread_create (&threads[i], NULL, rcu_test_reader, &args) == 0);
+    }
+  // grow and shrink the map repeatedly under the readers
+  for (int round = 0; round < 20; ++round)
+    {
+      for (int key = RCU_TEST_STABLE_KEYS; key < 2000; ++key)
+        {
+          my_pair = get_new_pair_int_int (key, key);
+          assert(rcu_hashmap_insert (args.map, my_pair) == 1);
+          pair_free (&my_pair);
+        }
+      for (int key = RCU_TEST_STABLE_KEYS; key < 2000; ++key)
+        {
+          assert(rcu_hashmap_erase (args.map, &key) == 1);
+        }
+    }
+  __atomic_store_n (&(args.done), 1, __ATOMIC_SEQ_CST);
+  for (int i = 0; i < RCU_TEST_READERS; ++i)
+    {
+      pthread_join (threads[i], NULL);
+    }
+  assert(args.map->size == RCU_TEST_STABLE_KEYS);
+  int key = RCU_TEST_STABLE_KEYS;
+  assert(rcu_hashmap_at (args.map, &key) == NULL);
+  assert(rcu_hashmap_erase (args.map, &key) == 0);
+  // Check for bad input:
+  assert(rcu_hashmap_insert (args.map, NULL) == 0);
+  assert(rcu_hashmap_at (NULL, &key) == NULL);
+  assert(rcu_hashmap_get_load_factor (NULL) == -1);
+  rcu_hashmap_free (&(args.map));
+  assert(args.map == NULL);
+  // A writer changing the links of the bucket a reader is looking in:
+  args.map = rcu_hashmap_alloc (hash_int);
+  args.done = 0;
+  my_pair = get_new_pair_int_int (0, 7);
+  assert(rcu_hashmap_insert (args.map, my_pair) == 1);
+  pair_free (&my_pair);
+  for (int i = 0; i < RCU_TEST_READERS; ++i)
+    {
+      assert(pthread_create (&threads[i], NULL, rcu_test_bucket_reader,
+                             &args) == 0);
+    }
+  key = (int) RCU_HASHMAP_INITIAL_CAP; // the bucket of 0
+  my_pair = get_new_pair_int_int (key, 999);
+  for (int round = 0; round < 200000; ++round)
+    {
+      assert(rcu_hashmap_insert (args.map, my_pair) == 1);
+      assert(rcu_hashmap_erase (args.map, &key) == 1);
+    }
+  pair_free (&my_pair);
+  __atomic_store_n (&(args.done), 1, __ATOMIC_SEQ_CST);
+  for (int i = 0; i < RCU_TEST_READERS; ++i)
+    {
+      pthread_join (threads[i], NULL);
+    }
+  assert(args.map->size == 1);
+  rcu_hashmap_free (&(args.map));
+}
+
+/**
+ * This function checks the hashmap_apply_if_parallel function of the hashmap
+ * library.
+ * If hashmap_apply_if_parallel fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_apply_if_parallel (void)
+{
+  hashmap *hm = hashmap_alloc_incremental (hash_int);
+  void *my_pair;
+  int key;
+  for (int i = 0; i < 800; ++i)
+    {
+      my_pair = get_new_pair_int_int (i, i);
+      hashmap_insert (hm, my_pair);
+      pair_free (&my_pair);
+    }
+  assert(hm->old_buckets != NULL); // 800 crossed 768, still migrating
+  // each value is changed exactly once - no matter how many threads
+  assert(hashmap_apply_if_parallel (hm, is_even, double_value, 4) == 400);
+  assert(hashmap_apply_if_parallel (hm, is_odd, negative_value, 3000) == 400);
+  assert(hashmap_apply_if_parallel (hm, is_even, negative_value, 0) == 400);
+  for (int i = 0; i < 800; ++i)
+    {
+      key = i;
+      assert(*(int *) hashmap_at (hm, &key) == (i % 2 ? -i : -2 * i));
+    }
+  // Check for bad input:
+  assert(hashmap_apply_if_parallel (NULL, is_even, double_value, 2) == -1);
+  assert(hashmap_apply_if_parallel (hm, NULL, double_value, 2) == -1);
+  assert(hashmap_apply_if_parallel (hm, is_even, NULL, 2) == -1);
+  hashmap_free (&hm);
+}
+
+static int typed_is_even (int key)
+{
+  return key % 2 == 0;
+}
+
+static int typed_is_upper (char key)
+{
+  return key >= 'A' && key <= 'Z';
+}
+
+static void typed_double_value (int *value)
+{
+  *value *= 2;
+}
+
+/**
+ * This function checks maps generated by DECLARE_HASHMAP (typed_hashmap.h).
+ * If a typed map fails at some points, the functions exits with exit code 1.
+ */
+void test_typed_hash_map (void)
+{
+  int_int_map *hm = int_int_map_alloc ();
+  // multiples of 16 all share a home slot - long probe sequences
+  for (int i = 0; i < 100; ++i)
+    {
+      assert(int_int_map_insert (hm, i * 16, i) == 1);
+      assert(int_int_map_insert (hm, i * 16, -i) == 0);
+    }
+  assert(hm->size == 100);
+  assert(hm->capacity == 256);
+  for (int i = 0; i < 100; ++i)
+    {
+      assert(*int_int_map_at (hm, i * 16) == i);
+      assert(int_int_map_at (hm, i * 16 + 1) == NULL);
+    }
+  assert(int_int_map_apply_if (hm, typed_is_even, typed_double_value) == 100);
+  *int_int_map_at (hm, 16) += 1;
+  assert(*int_int_map_at (hm, 16) == 3);
+  for (int i = 0; i < 100; i += 2)
+    {
+      assert(int_int_map_erase (hm, i * 16) == 1);
+      assert(int_int_map_erase (hm, i * 16) == 0);
+    }
+  for (int i = 3; i < 100; i += 2)
+    {
+      assert(*int_int_map_at (hm, i * 16) == 2 * i);
+    }
+  assert(hm->size == 50);
+  assert(hm->capacity == 128);
+  assert(int_int_map_get_load_factor (hm) == 50.0 / 128);
+  int_int_map_free (&hm);
+  assert(hm == NULL);
+
+  char_int_map *char_hm = char_int_map_alloc ();
+  for (char key = 'A'; key <= 'z'; ++key)
+    {
+      assert(char_int_map_insert (char_hm, key, key) == 1);
+    }
+  assert(char_hm->size == 'z' - 'A' + 1);
+  assert(char_int_map_apply_if (char_hm, typed_is_upper,
+                                typed_double_value) == 26);
+  assert(*char_int_map_at (char_hm, 'B') == 2 * 'B');
+  assert(*char_int_map_at (char_hm, 'b') == 'b');
+  assert(char_int_map_at (char_hm, '0') == NULL);
+  for (char key = 'A'; key <= 'z'; ++key)
+    {
+      assert(char_int_map_erase (char_hm, key) == 1);
+    }
+  assert(char_hm->size == 0);
+  assert(char_hm->capacity == TYPED_HASHMAP_MIN_CAP);
+  // Check for bad input:
+  assert(char_int_map_insert (NULL, 'a', 1) == 0);
+  assert(char_int_map_at (NULL, 'a') == NULL);
+  assert(char_int_map_erase (NULL, 'a') == 0);
+  assert(char_int_map_get_load_factor (NULL) == -1);
+  assert(char_int_map_apply_if (char_hm, NULL, typed_double_value) == -1);
+  char_int_map_free (&char_hm);
+  char_int_map_free (NULL);
+}
+
+/**
+ * This function checks the mixing hash funcs of hash_funcs.h.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_hash_funcs_mix (void)
+{
+  hashmap *hm = hashmap_alloc (hash_int_mix);
+  void *my_pair;
+  int key;
+  // with hash_int all of them would share a single bucket
+  for (int i = 0; i < 512; ++i)
+    {
+      my_pair = get_new_pair_int_int (i * 1024, i);
+      assert(hashmap_insert (hm, my_pair) == 1);
+      pair_free (&my_pair);
+    }
+  for (size_t i = 0; i < hm->capacity; ++i)
+    {
+      assert(hm->buckets[i].rest == NULL || hm->buckets[i].rest->size < 8);
+    }
+  for (int i = 0; i < 512; ++i)
+    {
+      key = i * 1024;
+      assert(*(int *) hashmap_at (hm, &key) == i);
+    }
+  hashmap_free (&hm);
+  char chars[2] = {'a', 'b'};
+  assert(hash_char_mix (&chars[0]) != hash_char_mix (&chars[1]));
+  char word_1[] = "hashmap", word_2[] = "hashmap", word_3[] = "hashmaq";
+  assert(hash_string (word_1) == hash_string (word_2));
+  assert(hash_string (word_1) != hash_string (word_3));
+  assert(hash_string ("") != hash_string ("a"));
+}
+
+/**
+ * This function checks the iterator (hashmap_iter_*) of the hashmap library.
+ * If the iterator fails at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_iter (void)
+{
+  hashmap *hm = hashmap_alloc_incremental (hash_int);
+  hashmap_iter it;
+  void *my_pair;
+  int seen[800] = {0};
+  int count = 0;
+  assert(hashmap_iter_begin (hm, &it) == 0);
+  assert(hashmap_iter_key (&it) == NULL && hashmap_iter_value (&it) == NULL);
+  assert(hashmap_iter_next (&it) == 0);
+  for (int i = 0; i < 800; ++i)
+    {
+      // multiples of 16 share buckets - exercises the overflow vectors
+      my_pair = get_new_pair_int_int (i % 2 ? i : i * 16, i);
+      hashmap_insert (hm, my_pair);
+      pair_free (&my_pair);
+    }
+  assert(hm->old_buckets != NULL); // the walk covers both bucket arrays
+  for (int more = hashmap_iter_begin (hm, &it); more;
+       more = hashmap_iter_next (&it))
+    {
+      int value = *(int *) hashmap_iter_value (&it);
+      int key = *(const int *) hashmap_iter_key (&it);
+      assert(key == (value % 2 ? value : value * 16));
+      assert(seen[value] == 0);
+      seen[value] = 1;
+      *(int *) hashmap_iter_value (&it) = -value;
+      ++count;
+    }
+  assert(count == 800);
+  assert(hashmap_iter_next (&it) == 0);
+  int key = 16 * 16;
+  assert(*(int *) hashmap_at (hm, &key) == -16);
+  // stopping early
+  count = 0;
+  for (int more = hashmap_iter_begin (hm, &it); more && count < 10;
+       more = hashmap_iter_next (&it))
+    {
+      ++count;
+    }
+  assert(count == 10 && hashmap_iter_key (&it) != NULL);
+  // Check for bad input:
+  assert(hashmap_iter_begin (NULL, &it) == 0);
+  assert(hashmap_iter_begin (hm, NULL) == 0);
+  assert(hashmap_iter_next (NULL) == 0);
+  assert(hashmap_iter_key (NULL) == NULL);
+  hashmap_free (&hm);
+}
+
+/**
+ * This function checks the compact_hashmap.
+ * If the compact_hashmap fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_compact_hash_map (void)
+{
+  compact_hashmap *hm = compact_hashmap_alloc (hash_int);
+  compact_hashmap_iter it;
+  void *my_pair;
+  int key, expected;
+  // multiples of 16 all share a home slot - long probe sequences
+  for (int i = 0; i < 100; ++i)
+    {
+      my_pair = get_new_pair_int_int (i * 16, i);
+      assert(compact_hashmap_insert (hm, my_pair) == 1);
+      assert(compact_hashmap_insert (hm, my_pair) == 0);
+      pair_free (&my_pair);
+    }
+  assert(hm->size == 100 && hm->used == 100);
+  assert(hm->capacity == 256);
+  for (int i = 0; i < 100; ++i)
+    {
+      key = i * 16;
+      assert(*(int *) compact_hashmap_at (hm, &key) == i);
+      key = i * 16 + 1;
+      assert(compact_hashmap_at (hm, &key) == NULL);
+    }
+  assert(compact_hashmap_apply_if (hm, is_even, double_value) == 100);
+  for (int i = 0; i < 100; i += 2)
+    {
+      key = i * 16;
+      assert(compact_hashmap_erase (hm, &key) == 1);
+      assert(compact_hashmap_erase (hm, &key) == 0);
+      key = (i + 1) * 16; // found past the tombstones
+      assert(*(int *) compact_hashmap_at (hm, &key) == 2 * (i + 1));
+    }
+  assert(hm->size == 50);
+  assert(hm->used - hm->size <= hm->used / 2); // tombstones were compacted
+  // the remaining pairs keep their insertion order
+  expected = 1;
+  for (int more = compact_hashmap_iter_begin (hm, &it); more;
+       more = compact_hashmap_iter_next (&it))
+    {
+      assert(*(const int *) compact_hashmap_iter_key (&it) == expected * 16);
+      assert(*(int *) compact_hashmap_iter_value (&it) == 2 * expected);
+      expected += 2;
+    }
+  assert(expected == 101);
+  assert(compact_hashmap_iter_key (&it) == NULL);
+  // re-inserted keys go to the end
+  my_pair = get_new_pair_int_int (0, 7);
+  assert(compact_hashmap_insert (hm, my_pair) == 1);
+  pair_free (&my_pair);
+  assert(*(int *) hm->entries[hm->used - 1].pair.key == 0);
+  for (int i = 1; i < 100; i += 2)
+    {
+      key = i * 16;
+      assert(compact_hashmap_erase (hm, &key) == 1);
+    }
+  assert(hm->size == 1 && hm->capacity == COMPACT_HASH_MAP_MIN_CAP);
+  key = 0;
+  assert(*(int *) compact_hashmap_at (hm, &key) == 7);
+  // Check for bad input:
+  assert(compact_hashmap_insert (hm, NULL) == 0);
+  assert(compact_hashmap_at (hm, NULL) == NULL);
+  assert(compact_hashmap_erase (NULL, &key) == 0);
+  assert(compact_hashmap_get_load_factor (NULL) == -1);
+  assert(compact_hashmap_apply_if (hm, NULL, double_value) == -1);
+  assert(compact_hashmap_iter_begin (NULL, &it) == 0);
+  compact_hashmap_free (&hm);
+  assert(hm == NULL);
+}
+
+/**
+ * counts the slabs of a pool
+ */
+static size_t count_slabs (const slab_pool *pool)
+{
+  size_t count = 0;
+  for (const arena_slab *slab = pool->slabs; slab != NULL; slab = slab->next)
+    {
+      ++count;
+    }
+  return count;
+}
+
+/**
+ * This function checks a hashmap allocated with hashmap_alloc_with_arena.
+ * If the arena hashmap fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_arena (void)
+{
+  hashmap *hm = hashmap_alloc_with_arena (hash_int);
+  const slab_pool *entries = &(hm->arena->pools
+  [(sizeof (hashmap_entry) + ARENA_ALIGN - 1) / ARENA_ALIGN - 1]);
+  void *my_pair;
+  int key;
+  for (int i = 0; i < 10000; ++i)
+    {
+      // the odd keys collide a lot - they need overflow vectors
+      my_pair = get_new_pair_int_int (i % 2 ? (i % 64) * 1024 + i : i, i);
+      assert(hashmap_insert (hm, my_pair) == 1);
+      pair_free (&my_pair);
+    }
+  assert(hm->size == 10000);
+  size_t n_slabs = count_slabs (entries);
+  assert(n_slabs * (ARENA_SLAB_SIZE / entries->block_size) >= 10000);
+  assert(n_slabs <= 10000 / (ARENA_SLAB_SIZE / entries->block_size) + 1);
+  for (int i = 0; i < 10000; ++i)
+    {
+      key = i % 2 ? (i % 64) * 1024 + i : i;
+      assert(*(int *) hashmap_at (hm, &key) == i);
+    }
+  for (int i = 0; i < 10000; i += 3)
+    {
+      key = i % 2 ? (i % 64) * 1024 + i : i;
+      assert(hashmap_erase (hm, &key) == 1);
+      assert(hashmap_at (hm, &key) == NULL);
+    }
+  for (int i = 1; i < 10000; i += 3)
+    {
+      key = i % 2 ? (i % 64) * 1024 + i : i;
+      assert(*(int *) hashmap_at (hm, &key) == i);
+    }
+  // the erased entries' blocks are reused
+  for (int i = 0; i < 10000; i += 3)
+    {
+      my_pair = get_new_pair_int_int (i % 2 ? (i % 64) * 1024 + i : i, -i);
+      assert(hashmap_insert (hm, my_pair) == 1);
+      pair_free (&my_pair);
+    }
+  assert(count_slabs (entries) == n_slabs);
+  assert(hashmap_apply_if (hm, is_even, double_value) == 5000);
+  hashmap_free (&hm);
+  assert(hm == NULL);
+}
+
+/**
+ * This function checks the resize policies (hashmap_set_resize_policy,
+ * hashmap_shrink_to_fit) of the hashmap library.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_resize_policy (void)
+{
+  hashmap *hm = hashmap_alloc (hash_int);
+  hashmap_resize_policy policy = hashmap_default_resize_policy ();
+  void *my_pair;
+  int key;
+  assert(policy.growth_factor == HASH_MAP_GROWTH_FACTOR);
+  assert(policy.max_load_factor == HASH_MAP_MAX_LOAD_FACTOR);
+  assert(policy.min_load_factor == HASH_MAP_MIN_LOAD_FACTOR);
+  // a growth factor of 4, at least 64 buckets, shrinking on demand only
+  policy.growth_factor = 4;
+  policy.min_load_factor = 0.1;
+  policy.min_capacity = 64;
+  policy.shrink_on_demand = 1;
+  assert(hashmap_set_resize_policy (hm, &policy) == 1);
+  assert(hm->capacity == 64);
+  for (int i = 0; i < 200; ++i)
+    {
+      my_pair = get_new_pair_int_int (i, i);
+      assert(hashmap_insert (hm, my_pair) == 1);
+      pair_free (&my_pair);
+    }
+  assert(hm->capacity == 1024); // 64 -> 256 (at 48) -> 1024 (at 192)
+  for (key = 0; key < 195; ++key)
+    {
+      assert(hashmap_erase (hm, &key) == 1);
+    }
+  assert(hm->capacity == 1024);
+  assert(hashmap_shrink_to_fit (hm) == 1);
+  assert(hm->capacity == 64);
+  for (key = 195; key < 200; ++key)
+    {
+      assert(*(int *) hashmap_at (hm, &key) == key);
+    }
+  hashmap_free (&hm);
+
+  // a shrink delay - oscillating around the min load factor resizes nothing
+  hm = hashmap_alloc (hash_int);
+  policy = hashmap_default_resize_policy ();
+  policy.shrink_delay = 8;
+  assert(hashmap_set_resize_policy (hm, &policy) == 1);
+  for (int i = 0; i < 12; ++i)
+    {
+      my_pair = get_new_pair_int_int (i, i);
+      hashmap_insert (hm, my_pair);
+      pair_free (&my_pair);
+    }
+  assert(hm->capacity == 16);
+  for (key = 11; key >= 4; --key)
+    {
+      assert(hashmap_erase (hm, &key) == 1);
+    }
+  for (int round = 0; round < 20; ++round)
+    {
+      key = 3; // 4 pairs in 16 buckets - at the min load factor
+      assert(hashmap_erase (hm, &key) == 1);
+      my_pair = get_new_pair_int_int (3, 3);
+      assert(hashmap_insert (hm, my_pair) == 1);
+      pair_free (&my_pair);
+      assert(hm->capacity == 16);
+    }
+  for (key = 3; key >= 0 && hm->capacity == 16; --key)
+    {
+      assert(hashmap_erase (hm, &key) == 1);
+    }
+  assert(hm->capacity == 16); // fewer than 9 low load erases in a row
+  hashmap_free (&hm);
+  // Check for bad input:
+  hm = hashmap_alloc (hash_int);
+  policy = hashmap_default_resize_policy ();
+  policy.growth_factor = 3;
+  assert(hashmap_set_resize_policy (hm, &policy) == 0);
+  policy = hashmap_default_resize_policy ();
+  policy.min_load_factor = 0.5; // 0.5 * 2 >= 0.75 - would thrash
+  assert(hashmap_set_resize_policy (hm, &policy) == 0);
+  policy = hashmap_default_resize_policy ();
+  policy.min_capacity = 0;
+  assert(hashmap_set_resize_policy (hm, &policy) == 0);
+  assert(hashmap_set_resize_policy (hm, NULL) == 0);
+  assert(hashmap_set_resize_policy (NULL, &policy) == 0);
+  assert(hm->policy.growth_factor == HASH_MAP_GROWTH_FACTOR);
+  assert(hashmap_shrink_to_fit (NULL) == 0);
+  hashmap_free (&hm);
+}
+
+/**
+ * This function checks the hashmap_stats function of the hashmap library.
+ * If hashmap_stats fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_stats (void)
+{
+  hashmap *hm = hashmap_alloc (hash_int);
+  hashmap_statistics stats;
+  void *my_pair;
+  int key;
+  for (int i = 0; i < 100; ++i)
+    {
+      // pairs of keys share buckets
+      my_pair = get_new_pair_int_int (i % 2 ? i - 1 + 1024 : i, i);
+      hashmap_insert (hm, my_pair);
+      pair_free (&my_pair);
+    }
+#ifdef HASHMAP_STATS
+  assert(hashmap_stats (hm, &stats) == 1);
+  assert(stats.rehash_count == 4); // 16 -> 32 -> 64 -> 128 -> 256
+  assert(stats.rehash_ns > 0);
+  assert(stats.lookups == 0);
+  size_t buckets = 0, pairs = 0;
+  for (size_t i = 0; i <= HASH_MAP_STATS_MAX_CHAIN; ++i)
+    {
+      buckets += stats.chain_lengths[i];
+      pairs += i * stats.chain_lengths[i];
+    }
+  assert(buckets == hm->capacity && pairs == 100);
+  assert(stats.chain_lengths[2] == 50);
+  assert(stats.bytes_allocated >= hm->capacity * sizeof (bucket)
+                                  + 100 * sizeof (hashmap_entry));
+  for (key = 0; key < 100; key += 2)
+    {
+      assert(hashmap_at (hm, &key) != NULL); // 1 or 2 probes
+      key += 1024;
+      assert(hashmap_at (hm, &key) != NULL);
+      key -= 1024;
+    }
+  key = 1; // a miss in an empty bucket
+  assert(hashmap_at (hm, &key) == NULL);
+  assert(hashmap_stats (hm, &stats) == 1);
+  assert(stats.lookups == 101);
+  assert(stats.avg_probes == 150.0 / 101);
+#else
+  key = 0;
+  assert(hashmap_at (hm, &key) != NULL);
+  assert(hashmap_stats (hm, &stats) == 0);
+#endif
+  // Check for bad input:
+  assert(hashmap_stats (NULL, &stats) == 0);
+  assert(hashmap_stats (hm, NULL) == 0);
+  hashmap_free (&hm);
+}
+
+/**
+ * This function checks the snapshot functions of the hashmap library.
+ * If hashmap_save, hashmap_open_mmap or hashmap_mmap_at fail at some points,
+ * the functions exits with exit code 1.
+ */
+void test_hash_map_mmap (void)
+{
+  const char *path = "test_hash_map_mmap.snapshot";
+  hashmap *hm = hashmap_alloc (hash_int);
+  void *my_pair;
+  int key;
+  for (int i = 0; i < 1000; ++i)
+    {
+      my_pair = get_new_pair_int_int (i * 1024, -i);
+      hashmap_insert (hm, my_pair);
+      pair_free (&my_pair);
+    }
+  assert(hashmap_save (hm, path, sizeof (int), sizeof (int)) == 1);
+  hashmap_free (&hm);
+  hashmap_mmap *snapshot = hashmap_open_mmap (path, hash_int);
+  assert(snapshot != NULL);
+  assert(snapshot->header->size == 1000);
+  assert(snapshot->header->capacity == 2048);
+  for (key = 0; key < 1000 * 1024; key += 1024)
+    {
+      assert(*(const int *) hashmap_mmap_at (snapshot, &key) == -key / 1024);
+    }
+  key = 1;
+  assert(hashmap_mmap_at (snapshot, &key) == NULL);
+  key = 1000 * 1024;
+  assert(hashmap_mmap_at (snapshot, &key) == NULL);
+  hashmap_mmap_close (&snapshot);
+  assert(snapshot == NULL);
+  // An empty map:
+  hm = hashmap_alloc (hash_int);
+  assert(hashmap_save (hm, path, sizeof (int), sizeof (int)) == 1);
+  snapshot = hashmap_open_mmap (path, hash_int);
+  assert(snapshot != NULL);
+  key = 0;
+  assert(hashmap_mmap_at (snapshot, &key) == NULL);
+  hashmap_mmap_close (&snapshot);
+  // Check for bad input:
+  assert(hashmap_save (NULL, path, sizeof (int), sizeof (int)) == 0);
+  assert(hashmap_save (hm, NULL, sizeof (int), sizeof (int)) == 0);
+  assert(hashmap_save (hm, path, 0, sizeof (int)) == 0);
+  assert(hashmap_save (hm, "no_such_dir/snapshot", sizeof (int),
+                       sizeof (int)) == 0);
+  assert(hashmap_open_mmap (NULL, hash_int) == NULL);
+  assert(hashmap_open_mmap (path, NULL) == NULL);
+  assert(hashmap_open_mmap ("no_such_dir/snapshot", hash_int) == NULL);
+  assert(hashmap_mmap_at (NULL, &key) == NULL);
+  hashmap_mmap_close (NULL);
+  hashmap_free (&hm);
+  FILE *file = fopen (path, "wb"); // not a snapshot
+  assert(file != NULL);
+  fputs ("not a snapshot, but long enough for a header", file);
+  fclose (file);
+  assert(hashmap_open_mmap (path, hash_int) == NULL);
+  // A char -> int map, its values are aligned after the 1 byte keys:
+  hm = hashmap_alloc (hash_char);
+  for (char c = 'a'; c <= 'z'; ++c)
+    {
+      my_pair = get_new_pair_char_int (c, c * 100);
+      hashmap_insert (hm, my_pair);
+      pair_free (&my_pair);
+    }
+  assert(hashmap_save (hm, path, sizeof (char), sizeof (int)) == 1);
+  hashmap_free (&hm);
+  snapshot = hashmap_open_mmap (path, hash_char);
+  assert(snapshot != NULL);
+  assert(snapshot->header->value_offset % sizeof (int) == 0);
+  const int *value;
+  for (char c = 'a'; c <= 'z'; ++c)
+    {
+      value = (const int *) hashmap_mmap_at (snapshot, &c);
+      assert(value != NULL && (uintptr_t) value % sizeof (int) == 0);
+      assert(*value == c * 100);
+    }
+  char missing = 'A';
+  assert(hashmap_mmap_at (snapshot, &missing) == NULL);
+  // A snapshot whose slots are all marked used (never saved so) still opens,
+  // but a lookup of a missing key ends after a pass over the slots:
+  const hashmap_mmap_header header = *snapshot->header;
+  size_t length = snapshot->length;
+  unsigned char *bytes = (unsigned char *) malloc (length);
+  assert(bytes != NULL);
+  memcpy (bytes, snapshot->header, length);
+  hashmap_mmap_close (&snapshot);
+  uint64_t used = 1;
+  for (uint64_t i = 0; i < header.capacity; ++i)
+    {
+      memcpy (bytes + sizeof (header) + i * header.slot_size, &used,
+              sizeof (used));
+    }
+  file = fopen (path, "wb");
+  assert(file != NULL);
+  assert(fwrite (bytes, length, 1, file) == 1);
+  fclose (file);
+  snapshot = hashmap_open_mmap (path, hash_char);
+  assert(snapshot != NULL);
+  assert(hashmap_mmap_at (snapshot, &missing) == NULL);
+  char last = 'z';
+  assert(*(const int *) hashmap_mmap_at (snapshot, &last) == 'z' * 100);
+  hashmap_mmap_close (&snapshot);
+  // A key_size whose padded size wraps around to match the offsets:
+  hashmap_mmap_header *bad_header = (hashmap_mmap_header *) bytes;
+  bad_header->key_size = UINT64_MAX - 3;
+  bad_header->value_offset = 16;
+  bad_header->slot_size = 24;
+  file = fopen (path, "wb");
+  assert(file != NULL);
+  assert(fwrite (bytes, length, 1, file) == 1);
+  fclose (file);
+  assert(hashmap_open_mmap (path, hash_char) == NULL);
+  // A truncated snapshot:
+  *bad_header = header;
+  file = fopen (path, "wb");
+  assert(file != NULL);
+  assert(fwrite (bytes, length - header.slot_size, 1, file) == 1);
+  fclose (file);
+  assert(hashmap_open_mmap (path, hash_char) == NULL);
+  free (bytes);
+  remove (path);
+}
+
+/**
+ * This function checks the hashmap_at_batch function of the hashmap library.
+ * If hashmap_at_batch fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_hash_map_at_batch (void)
+{
+  hashmap *hm = hashmap_alloc (hash_int);
+  void *my_pair;
+  int keys[100];
+  const_keyT key_ptrs[100];
+  valueT values[100];
+  for (int i = 0; i < 100; ++i)
+    {
+      keys[i] = i % 2 ? -i : i; // the odd keys are not in the map
+      key_ptrs[i] = &keys[i];
+    }
+  for (int i = 0; i < 100; i += 2)
+    {
+      my_pair = get_new_pair_int_int (i, i * 10);
+      hashmap_insert (hm, my_pair);
+      pair_free (&my_pair);
+    }
+  key_ptrs[98] = NULL;
+  assert(hashmap_at_batch (hm, key_ptrs, 100, values) == 49);
+  for (int i = 0; i < 98; ++i)
+    {
+      assert(values[i] == hashmap_at (hm, &keys[i]));
+    }
+  assert(values[98] == NULL && values[99] == NULL);
+  // In the middle of an incremental resize:
+  hashmap *incremental = hashmap_alloc_incremental (hash_int);
+  for (int i = 0; i < 100; i += 2)
+    {
+      my_pair = get_new_pair_int_int (i, i * 10);
+      hashmap_insert (incremental, my_pair);
+      pair_free (&my_pair);
+    }
+  assert(incremental->old_buckets != NULL);
+  key_ptrs[98] = &keys[98];
+  assert(hashmap_at_batch (incremental, key_ptrs, 100, values) == 50);
+  for (int i = 0; i < 100; ++i)
+    {
+      assert(values[i] == hashmap_at (incremental, &keys[i]));
+    }
+  // Check for bad input:
+  assert(hashmap_at_batch (hm, key_ptrs, 0, values) == 0);
+  assert(hashmap_at_batch (NULL, key_ptrs, 100, values) == -1);
+  assert(hashmap_at_batch (hm, NULL, 100, values) == -1);
+  assert(hashmap_at_batch (hm, key_ptrs, 100, NULL) == -1);
+  hashmap_free (&incremental);
+  hashmap_free (&hm);
+}
+
+/**
+ * This function checks the swiss_hashmap engine.
+ * If the swiss_hashmap fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_swiss_hash_map (void)
+{
+  swiss_hashmap *hm = swiss_hashmap_alloc (hash_int);
+  void *my_pair;
+  int key;
+  for (int i = 0; i < 1000; ++i)
+    {
+      my_pair = get_new_pair_int_int (i * 1024, i);
+      assert(swiss_hashmap_insert (hm, my_pair) == 1);
+      assert(swiss_hashmap_insert (hm, my_pair) == 0);
+      pair_free (&my_pair);
+    }
+  assert(hm->size == 1000);
+  assert(hm->capacity == 2048); // 1024 slots hold up to 896
+  for (int i = 0; i < 1000; ++i)
+    {
+      key = i * 1024;
+      assert(*(int *) swiss_hashmap_at (hm, &key) == i);
+      key = i * 1024 + 1;
+      assert(swiss_hashmap_at (hm, &key) == NULL);
+    }
+  assert(swiss_hashmap_apply_if (hm, is_even, double_value) == 1000);
+  key = 1024;
+  assert(*(int *) swiss_hashmap_at (hm, &key) == 2);
+  for (int i = 0; i < 1000; i += 2)
+    {
+      key = i * 1024;
+      assert(swiss_hashmap_erase (hm, &key) == 1);
+      assert(swiss_hashmap_erase (hm, &key) == 0);
+    }
+  for (int i = 1; i < 1000; i += 2)
+    {
+      key = i * 1024;
+      assert(*(int *) swiss_hashmap_at (hm, &key) == 2 * i);
+    }
+  assert(hm->size == 500);
+  assert(hm->capacity == 1024); // shrunk below a load of 0.25
+  swiss_hashmap_free (&hm);
+  assert(hm == NULL);
+  // Inserting and erasing keys around a steady set - the deleted markers
+  // are cleaned up without growing the map:
+  hm = swiss_hashmap_alloc (hash_int);
+  for (int i = 0; i < 100; ++i)
+    {
+      my_pair = get_new_pair_int_int (-i - 1, i);
+      swiss_hashmap_insert (hm, my_pair);
+      pair_free (&my_pair);
+    }
+  size_t max_deleted = 0;
+  for (int i = 0; i < 1000; ++i)
+    {
+      my_pair = get_new_pair_int_int (i, i);
+      assert(swiss_hashmap_insert (hm, my_pair) == 1);
+      pair_free (&my_pair);
+      assert(swiss_hashmap_erase (hm, &i) == 1);
+      max_deleted = hm->deleted > max_deleted ? hm->deleted : max_deleted;
+    }
+  assert(max_deleted > 0);
+  assert(hm->capacity == 128);
+  for (int i = 0; i < 100; ++i)
+    {
+      key = -i - 1;
+      assert(*(int *) swiss_hashmap_at (hm, &key) == i);
+    }
+  // Check for bad input:
+  assert(swiss_hashmap_alloc (NULL) == NULL);
+  assert(swiss_hashmap_insert (hm, NULL) == 0);
+  assert(swiss_hashmap_at (hm, NULL) == NULL);
+  assert(swiss_hashmap_erase (NULL, &key) == 0);
+  assert(swiss_hashmap_get_load_factor (NULL) == -1);
+  assert(swiss_hashmap_apply_if (hm, NULL, double_value) == -1);
+  swiss_hashmap_free (&hm);
+}
+
+/**
+ * This function checks an inline vector.
+ * If the vector fails at some points, the functions
+ * exits with exit code 1.
+ */
+void test_vector_inline (void)
+{
+  vector *vec = vector_alloc_inline (sizeof (int), NULL);
+  assert(vec != NULL);
+  for (int i = 0; i < 100; ++i)
+    {
+      assert(vector_push_back (vec, &i) == 1);
+    }
+  assert(vec->size == 100);
+  assert(vec->capacity == 256);
+  // the elements are contiguous in the vector's own buffer
+  int *first = vector_at (vec, 0);
+  for (int i = 0; i < 100; ++i)
+    {
+      assert(vector_at (vec, i) == first + i);
+      assert(*(int *) vector_at (vec, i) == i);
+      assert(vector_find (vec, &i) == i);
+    }
+  int missing = 100;
+  assert(vector_find (vec, &missing) == -1);
+  assert(vector_at (vec, 100) == NULL);
+  for (int i = 0; i < 90; ++i)
+    {
+      assert(vector_erase (vec, 0) == 1);
+    }
+  assert(vec->size == 10);
+  assert(*(int *) vector_at (vec, 0) == 90);
+  assert(*(int *) vector_at (vec, 9) == 99);
+  // pointer vector only operations:
+  assert(vector_push_back_owned (vec, &missing) == 0);
+  assert(vector_detach_back (vec) == NULL);
+  vector_clear (vec);
+  assert(vec->size == 0);
+  vector_free (&vec);
+  assert(vec == NULL);
+  // with a compare function:
+  vec = vector_alloc_inline (sizeof (char), char_key_cmp);
+  char letter = 'a';
+  assert(vector_push_back (vec, &letter) == 1);
+  assert(vector_find (vec, &letter) == 0);
+  vector_free (&vec);
+  // Check for bad input:
+  assert(vector_alloc_inline (0, NULL) == NULL);
+}
+
+/**
+ * This function checks the erase variants of the vector.
+ * If vector_erase_unordered, vector_erase_range or vector_erase_if fail at
+ * some points, the functions exits with exit code 1.
+ */
+void test_vector_erase_variants (void)
+{
+  vector *vec = vector_alloc (int_value_cpy, int_value_cmp, int_value_free);
+  for (int i = 0; i < 100; ++i)
+    {
+      vector_push_back (vec, &i);
+    }
+  assert(vector_erase_range (vec, 10, 60) == 1);
+  assert(vec->size == 50);
+  assert(vec->capacity == 256); // the load was 100 / 256 before the erase
+  assert(*(int *) vector_at (vec, 9) == 9);
+  assert(*(int *) vector_at (vec, 10) == 60);
+  assert(*(int *) vector_at (vec, 49) == 99);
+  assert(vector_erase_if (vec, is_even) == 25);
+  assert(vec->size == 25);
+  assert(vec->capacity == 128); // halved once, not down to 25 / 64
+  for (int i = 0; i < 5; ++i)
+    {
+      assert(*(int *) vector_at (vec, i) == 2 * i + 1);
+      assert(*(int *) vector_at (vec, 5 + i) == 61 + 2 * i);
+    }
+  assert(vector_erase_unordered (vec, 0) == 1);
+  assert(vec->size == 24 && vec->capacity == 64);
+  assert(*(int *) vector_at (vec, 0) == 99);
+  assert(*(int *) vector_at (vec, 1) == 3);
+  assert(vector_erase_unordered (vec, 23) == 1); // the last one
+  assert(vec->size == 23);
+  assert(*(int *) vector_at (vec, 22) == 95);
+  assert(vector_erase (vec, 0) == 1);
+  assert(*(int *) vector_at (vec, 0) == 3);
+  assert(vector_erase_range (vec, 0, vec->size) == 1);
+  assert(vec->size == 0 && vec->capacity == 64);
+  // Check for bad input:
+  assert(vector_erase_range (vec, 0, 0) == 0);
+  assert(vector_erase_range (vec, 0, 1) == 0);
+  assert(vector_erase_unordered (vec, 0) == 0);
+  assert(vector_erase_if (vec, NULL) == -1);
+  assert(vector_erase_if (NULL, is_even) == -1);
+  vector_free (&vec);
+  // The capacity is halved once, by the load factor before the erase:
+  vec = vector_alloc (int_value_cpy, int_value_cmp, int_value_free);
+  for (int i = 0; i < 5; ++i)
+    {
+      vector_push_back (vec, &i);
+    }
+  assert(vec->capacity == 16);
+  assert(vector_erase (vec, 0) == 1);
+  assert(vec->size == 4 && vec->capacity == 16);
+  assert(vector_erase (vec, 0) == 1);
+  assert(vec->size == 3 && vec->capacity == 8);
+  assert(vector_erase_range (vec, 0, 3) == 1);
+  assert(vec->size == 0 && vec->capacity == 8);
+  vector_free (&vec);
+  // An inline vector:
+  vec = vector_alloc_inline (sizeof (int), NULL);
+  for (int i = 0; i < 100; ++i)
+    {
+      vector_push_back (vec, &i);
+    }
+  assert(vector_erase_if (vec, is_even) == 50);
+  assert(vector_erase_range (vec, 0, 10) == 1);
+  assert(vector_erase_unordered (vec, 0) == 1);
+  assert(vec->size == 39);
+  assert(*(int *) vector_at (vec, 0) == 99);
+  assert(*(int *) vector_at (vec, 1) == 23);
+  vector_free (&vec);
+}
+
+/**
+ * This function checks the capacity functions of the vector.
+ * If vector_reserve, vector_shrink_to_fit, vector_clear_keep_capacity or
+ * vector_push_back_n fail at some points, the functions exits with exit
+ * code 1.
+ */
+void test_vector_capacity (void)
+{
+  vector *vec = vector_alloc (int_value_cpy, int_value_cmp, int_value_free);
+  assert(vector_reserve (vec, 100) == 1);
+  assert(vec->capacity == 256);
+  assert(vector_reserve (vec, 10) == 1); // never minimizes
+  assert(vec->capacity == 256);
+  int nums[100];
+  const void *values[100];
+  for (int i = 0; i < 100; ++i)
+    {
+      nums[i] = i;
+      values[i] = &nums[i];
+    }
+  assert(vector_push_back_n (vec, values, 100) == 1);
+  assert(vec->size == 100 && vec->capacity == 256);
+  assert(*(int *) vector_at (vec, 99) == 99);
+  vector_clear_keep_capacity (vec);
+  assert(vec->size == 0 && vec->capacity == 256);
+  assert(vector_push_back_n (vec, values, 100) == 1);
+  assert(vec->capacity == 256);
+  assert(vector_shrink_to_fit (vec) == 1);
+  assert(vec->capacity == 256); // 100 elements would fill 128 too much
+  assert(vector_erase_range (vec, 10, 100) == 1);
+  assert(vector_shrink_to_fit (vec) == 1);
+  assert(vec->capacity == 16);
+  vector_clear (vec);
+  assert(vector_shrink_to_fit (vec) == 1);
+  assert(vec->capacity == 1);
+  assert(vector_push_back (vec, &nums[0]) == 1);
+  assert(vector_push_back (vec, &nums[1]) == 1);
+  // all or nothing:
+  values[50] = NULL;
+  assert(vector_push_back_n (vec, values, 100) == 0);
+  assert(vec->size == 2);
+  assert(vector_push_back_n (vec, values, 0) == 1);
+  vector_free (&vec);
+  // An inline vector:
+  vec = vector_alloc_inline (sizeof (int), NULL);
+  assert(vector_push_back_n (vec, values, 50) == 1);
+  assert(vec->size == 50 && vec->capacity == 128);
+  assert(*(int *) vector_at (vec, 49) == 49);
+  vector_free (&vec);
+  // Check for bad input:
+  assert(vector_reserve (NULL, 10) == 0);
+  assert(vector_shrink_to_fit (NULL) == 0);
+  assert(vector_push_back_n (NULL, values, 10) == 0);
+  vector_clear_keep_capacity (NULL);
+}
+
+/**
+ * orders two ints (a vector_elem_order)
+ */
+static int int_order (const void *a, const void *b)
+{
+  int x = *(const int *) a, y = *(const int *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * checks that a vector of ints is sorted and holds size elements
+ */
+static void assert_sorted (const vector *vec, size_t size)
+{
+  assert(vec->size == size);
+  for (size_t i = 1; i < vec->size; ++i)
+    {
+      assert(*(int *) vector_at (vec, i - 1) <= *(int *) vector_at (vec, i));
+    }
+}
+
+/**
+ * This function checks the sorted functions of the vector.
+ * If vector_sort, vector_bsearch or vector_insert_sorted fail at some
+ * points, the functions exits with exit code 1.
+ */
+void test_vector_sorted (void)
+{
+  vector *vec = vector_alloc (int_value_cpy, int_value_cmp, int_value_free);
+  int value;
+  assert(vector_sort (vec) == 0); // no order yet
+  assert(vector_set_order (vec, int_order) == 1);
+  unsigned seed = 12345;
+  for (int i = 0; i < 1000; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      value = (int) (seed >> 16) % 500; // repeated values too
+      vector_push_back (vec, &value);
+    }
+  assert(vector_sort (vec) == 1);
+  assert_sorted (vec, 1000);
+  for (value = 0; value < 500; ++value)
+    {
+      int ind = vector_bsearch (vec, &value);
+      assert(ind == -1 || *(int *) vector_at (vec, ind) == value);
+      assert(ind == vector_find (vec, &value)); // the first one
+    }
+  value = 500;
+  assert(vector_bsearch (vec, &value) == -1);
+  value = -1;
+  assert(vector_bsearch (vec, &value) == -1);
+  assert(vector_sort (vec) == 1); // already sorted
+  assert_sorted (vec, 1000);
+  for (int i = 0; i < 100; ++i)
+    {
+      value = i * 7 % 550 - 20;
+      assert(vector_insert_sorted (vec, &value) == 1);
+    }
+  assert_sorted (vec, 1100);
+  vector_free (&vec);
+  // Reversed and constant input, on an inline vector:
+  vec = vector_alloc_inline (sizeof (int), NULL);
+  vector_set_order (vec, int_order);
+  for (value = 1000; value > 0; --value)
+    {
+      vector_push_back (vec, &value);
+    }
+  assert(vector_sort (vec) == 1);
+  assert_sorted (vec, 1000);
+  assert(*(int *) vector_at (vec, 0) == 1);
+  value = 1;
+  assert(vector_bsearch (vec, &value) == 0);
+  value = 0;
+  assert(vector_insert_sorted (vec, &value) == 1);
+  value = 1001;
+  assert(vector_insert_sorted (vec, &value) == 1);
+  assert_sorted (vec, 1002);
+  assert(*(int *) vector_at (vec, 1001) == 1001);
+  vector_clear (vec);
+  value = 7;
+  for (int i = 0; i < 1000; ++i)
+    {
+      vector_push_back (vec, &value);
+    }
+  assert(vector_sort (vec) == 1);
+  assert_sorted (vec, 1000);
+  assert(vector_bsearch (vec, &value) == 0);
+  vector_free (&vec);
+  // Check for bad input:
+  assert(vector_set_order (NULL, int_order) == 0);
+  assert(vector_sort (NULL) == 0);
+  assert(vector_bsearch (NULL, &value) == -1);
+  assert(vector_insert_sorted (NULL, &value) == 0);
+}
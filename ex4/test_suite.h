@@ -35,4 +35,175 @@ void test_hash_map_get_load_factor(void);
  */
 void test_hash_map_apply_if();
 
+/**
+ * This function checks the oa_hashmap (open addressing) engine: insertion,
+ * lookup, erasing and the capacity changes.
+ * If the oa_hashmap fails at some points, the functions exits with exit code 1.
+ */
+void test_oa_hash_map(void);
+
+/**
+ * This function checks a hashmap allocated with hashmap_alloc_incremental,
+ * including lookups and erasing while a resize is still in progress.
+ * If the incremental hashmap fails at some points, the functions exits with
+ * exit code 1.
+ */
+void test_hash_map_incremental(void);
+
+/**
+ * This function checks that the hashmap's buckets allocate nothing until
+ * pairs are pushed into them, and the overflow vector only on a collision.
+ * If the buckets fail at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_lazy_buckets(void);
+
+/**
+ * This function checks the hashmap_try_emplace and hashmap_insert_or_assign
+ * functions of the hashmap library, and that writes hash the key only once.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_try_emplace_insert_or_assign(void);
+
+/**
+ * This function checks that the hashmap caches the keys' hashes: resizing
+ * the map never calls its hash function.
+ * If the hashmap fails at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_cached_hash(void);
+
+/**
+ * This function checks the hashmap_reserve and hashmap_insert_bulk functions
+ * of the hashmap library.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_reserve_insert_bulk(void);
+
+/**
+ * This function checks the concurrent_hashmap, also with several threads
+ * inserting and erasing at once.
+ * If the concurrent_hashmap fails at some points, the functions exits with
+ * exit code 1.
+ */
+void test_concurrent_hash_map(void);
+
+/**
+ * This function checks the rcu_hashmap, also with reader threads looking
+ * keys up while the map is written and resized.
+ * If the rcu_hashmap fails at some points, the functions exits with exit
+ * code 1.
+ */
+void test_rcu_hash_map(void);
+
+/**
+ * This function checks the hashmap_apply_if_parallel function of the hashmap
+ * library, also while an incremental resize is in progress.
+ * If hashmap_apply_if_parallel fails at some points, the functions exits with
+ * exit code 1.
+ */
+void test_hash_map_apply_if_parallel(void);
+
+/**
+ * This function checks the hash maps generated by DECLARE_HASHMAP, with
+ * int and char keys.
+ * If a typed hash map fails at some points, the functions exits with exit
+ * code 1.
+ */
+void test_typed_hash_map(void);
+
+/**
+ * This function checks the mixing hash funcs (hash_int_mix, hash_char_mix,
+ * hash_string) of hash_funcs.h.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_hash_funcs_mix(void);
+
+/**
+ * This function checks the iterator (hashmap_iter_begin / next / key /
+ * value) of the hashmap library, also while an incremental resize is in
+ * progress.
+ * If the iterator fails at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_iter(void);
+
+/**
+ * This function checks the compact_hashmap, including its insertion order
+ * iteration and the compaction of erased entries.
+ * If the compact_hashmap fails at some points, the functions exits with
+ * exit code 1.
+ */
+void test_compact_hash_map(void);
+
+/**
+ * This function checks a hashmap allocated with hashmap_alloc_with_arena,
+ * its entries and overflow vectors taken from slab pools.
+ * If the arena hashmap fails at some points, the functions exits with exit
+ * code 1.
+ */
+void test_hash_map_arena(void);
+
+/**
+ * This function checks the resize policies (hashmap_set_resize_policy,
+ * hashmap_shrink_to_fit) of the hashmap library.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_resize_policy(void);
+
+/**
+ * This function checks the hashmap_stats function of the hashmap library
+ * (its counters are checked only if compiled with HASHMAP_STATS).
+ * If hashmap_stats fails at some points, the functions exits with exit
+ * code 1.
+ */
+void test_hash_map_stats(void);
+
+/**
+ * This function checks hashmap_save, hashmap_open_mmap and hashmap_mmap_at
+ * of the hashmap library (on a snapshot file in the working directory).
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_hash_map_mmap(void);
+
+/**
+ * This function checks the hashmap_at_batch function of the hashmap library.
+ * If hashmap_at_batch fails at some points, the functions exits with exit
+ * code 1.
+ */
+void test_hash_map_at_batch(void);
+
+/**
+ * This function checks the swiss_hashmap engine: insertion, lookup, erasing
+ * (with and without deleted markers) and the capacity changes.
+ * If the swiss_hashmap fails at some points, the functions exits with exit
+ * code 1.
+ */
+void test_swiss_hash_map(void);
+
+/**
+ * This function checks an inline vector (vector_alloc_inline): pushing,
+ * finding, erasing and clearing elements stored by value.
+ * If the vector fails at some points, the functions exits with exit code 1.
+ */
+void test_vector_inline(void);
+
+/**
+ * This function checks vector_erase_unordered, vector_erase_range and
+ * vector_erase_if, on a vector of pointers and on an inline vector.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_vector_erase_variants(void);
+
+/**
+ * This function checks vector_reserve, vector_shrink_to_fit,
+ * vector_clear_keep_capacity and vector_push_back_n.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_vector_capacity(void);
+
+/**
+ * This function checks vector_sort, vector_bsearch and vector_insert_sorted
+ * on random, sorted, reversed and repetitive input.
+ * If they fail at some points, the functions exits with exit code 1.
+ */
+void test_vector_sorted(void);
+
 #endif //TESTSUITE_H_
@@ -0,0 +1,269 @@
+#ifndef TYPED_HASHMAP_H_
+#define TYPED_HASHMAP_H_
+
+#include <stdlib.h>
+
+/**
+ * @def TYPED_HASHMAP_INITIAL_CAP
+ * The initial capacity (number of slots) of a typed hash map.
+ */
+#define TYPED_HASHMAP_INITIAL_CAP 16UL
+
+/**
+ * @def TYPED_HASHMAP_MIN_CAP
+ * The capacity a typed hash map never shrinks below.
+ */
+#define TYPED_HASHMAP_MIN_CAP 8UL
+
+/**
+ * @def TYPED_HASHMAP_GROWTH_FACTOR
+ * The growth factor of a typed hash map.
+ */
+#define TYPED_HASHMAP_GROWTH_FACTOR 2UL
+
+/**
+ * @def TYPED_HASHMAP_MIN_LOAD_FACTOR
+ * After an erase that drops the load factor below it, the map is minimized.
+ */
+#define TYPED_HASHMAP_MIN_LOAD_FACTOR 0.25
+
+/**
+ * @def TYPED_HASHMAP_MAX_LOAD_FACTOR
+ * An insertion at (or above) this load factor extends the map first.
+ */
+#define TYPED_HASHMAP_MAX_LOAD_FACTOR 0.75
+
+/**
+ * @def TYPED_HASHMAP_EQ
+ * An eq for DECLARE_HASHMAP comparing keys with ==.
+ */
+#define TYPED_HASHMAP_EQ(key_1, key_2) ((key_1) == (key_2))
+
+/**
+ * @def TYPED_HASHMAP_HASH_INTEGRAL
+ * A hash for DECLARE_HASHMAP of integral keys (the key itself).
+ */
+#define TYPED_HASHMAP_HASH_INTEGRAL(key) ((size_t) (key))
+
+/**
+ * @def DECLARE_HASHMAP
+ * Generates a hash map type specialized for keys of type K and values of
+ * type V. The keys and values are stored by value (copied with =) in one
+ * flat slot array with Robin Hood linear probing, so an insertion allocates
+ * nothing (except on resize) and hash / eq are inlined into the probe loop.
+ * The generated type and functions mirror hashmap.h:
+ *   name *name_alloc (void);
+ *   void name_free (name **p_hash_map);
+ *   int name_insert (name *hash_map, K key, V value);
+ *   V *name_at (const name *hash_map, K key);
+ *   int name_erase (name *hash_map, K key);
+ *   double name_get_load_factor (const name *hash_map);
+ *   int name_apply_if (const name *hash_map, int (*key_func) (K),
+ *                      void (*val_func) (V *));
+ * name_at returns a pointer to the value inside the map, valid until the
+ * map is modified.
+ * @param name the name of the generated type and prefix of its functions.
+ * @param K the keys' type.
+ * @param V the values' type.
+ * @param hash a function or macro: size_t hash (K key).
+ * @param eq a function or macro: int eq (K key_1, K key_2), non-zero iff
+ * the keys are equal.
+ */
+#define DECLARE_HASHMAP(name, K, V, hash, eq)                                 \
+                                                                              \
+typedef struct name##_slot {                                                  \
+    size_t dist; /* probe distance + 1, 0 marks an empty slot */             \
+    K key;                                                                    \
+    V value;                                                                  \
+} name##_slot;                                                                \
+                                                                              \
+typedef struct name {                                                         \
+    name##_slot *slots;                                                       \
+    size_t size;                                                              \
+    size_t capacity;                                                          \
+} name;                                                                       \
+                                                                              \
+static inline void name##_place (name##_slot *slots, size_t cap,              \
+                                 name##_slot entry)                           \
+{                                                                             \
+  size_t mask = cap - 1;                                                      \
+  size_t ind = (hash (entry.key)) & mask;                                     \
+  name##_slot temp;                                                           \
+  entry.dist = 1;                                                             \
+  while (slots[ind].dist != 0)                                                \
+    {                                                                         \
+      if (slots[ind].dist < entry.dist)                                       \
+        {                                                                     \
+          temp = slots[ind];                                                  \
+          slots[ind] = entry;                                                 \
+          entry = temp;                                                       \
+        }                                                                     \
+      ind = (ind + 1) & mask;                                                 \
+      ++entry.dist;                                                           \
+    }                                                                         \
+  slots[ind] = entry;                                                         \
+}                                                                             \
+                                                                              \
+static inline long name##_find (const name *hash_map, K key)                  \
+{                                                                             \
+  size_t mask = hash_map->capacity - 1;                                       \
+  size_t ind = (hash (key)) & mask;                                           \
+  size_t dist = 1;                                                            \
+  while (hash_map->slots[ind].dist >= dist)                                   \
+    {                                                                         \
+      if (eq (hash_map->slots[ind].key, key))                                 \
+        {                                                                     \
+          return (long) ind;                                                  \
+        }                                                                     \
+      ind = (ind + 1) & mask;                                                 \
+      ++dist;                                                                 \
+    }                                                                         \
+  return -1;                                                                  \
+}                                                                             \
+                                                                              \
+static inline int name##_resize (name *hash_map, size_t new_cap)              \
+{                                                                             \
+  name##_slot *slots = (name##_slot *) calloc (new_cap, sizeof (name##_slot));\
+  if (slots == NULL)                                                          \
+    {                                                                         \
+      return 0;                                                               \
+    }                                                                         \
+  for (size_t i = 0; i < hash_map->capacity; ++i)                             \
+    {                                                                         \
+      if (hash_map->slots[i].dist != 0)                                       \
+        {                                                                     \
+          name##_place (slots, new_cap, hash_map->slots[i]);                  \
+        }                                                                     \
+    }                                                                         \
+  free (hash_map->slots);                                                     \
+  hash_map->slots = slots;                                                    \
+  hash_map->capacity = new_cap;                                               \
+  return 1;                                                                   \
+}                                                                             \
+                                                                              \
+static inline name *name##_alloc (void)                                       \
+{                                                                             \
+  name *new_hash = (name *) malloc (sizeof (name));                           \
+  if (new_hash == NULL)                                                       \
+    {                                                                         \
+      return NULL;                                                            \
+    }                                                                         \
+  new_hash->slots = (name##_slot *) calloc (TYPED_HASHMAP_INITIAL_CAP,        \
+                                            sizeof (name##_slot));            \
+  if (new_hash->slots == NULL)                                                \
+    {                                                                         \
+      free (new_hash);                                                        \
+      return NULL;                                                            \
+    }                                                                         \
+  new_hash->size = 0;                                                         \
+  new_hash->capacity = TYPED_HASHMAP_INITIAL_CAP;                             \
+  return new_hash;                                                            \
+}                                                                             \
+                                                                              \
+static inline void name##_free (name **p_hash_map)                            \
+{                                                                             \
+  if (p_hash_map == NULL || *p_hash_map == NULL)                              \
+    {                                                                         \
+      return;                                                                 \
+    }                                                                         \
+  free ((*p_hash_map)->slots);                                                \
+  free (*p_hash_map);                                                         \
+  *p_hash_map = NULL;                                                         \
+}                                                                             \
+                                                                              \
+static inline double name##_get_load_factor (const name *hash_map)            \
+{                                                                             \
+  if (hash_map == NULL || hash_map->capacity == 0)                            \
+    {                                                                         \
+      return -1;                                                              \
+    }                                                                         \
+  return (double) hash_map->size / hash_map->capacity;                        \
+}                                                                             \
+                                                                              \
+static inline int name##_insert (name *hash_map, K key, V value)              \
+{                                                                             \
+  if (hash_map == NULL || name##_find (hash_map, key) != -1)                  \
+    {                                                                         \
+      return 0;                                                               \
+    }                                                                         \
+  if (name##_get_load_factor (hash_map) >= TYPED_HASHMAP_MAX_LOAD_FACTOR      \
+      && name##_resize (hash_map, hash_map->capacity                          \
+                                  * TYPED_HASHMAP_GROWTH_FACTOR) == 0)        \
+    {                                                                         \
+      return 0;                                                               \
+    }                                                                         \
+  name##_slot entry;                                                          \
+  entry.key = key;                                                            \
+  entry.value = value;                                                        \
+  name##_place (hash_map->slots, hash_map->capacity, entry);                  \
+  hash_map->size++;                                                           \
+  return 1;                                                                   \
+}                                                                             \
+                                                                              \
+static inline V *name##_at (const name *hash_map, K key)                      \
+{                                                                             \
+  if (hash_map == NULL)                                                       \
+    {                                                                         \
+      return NULL;                                                            \
+    }                                                                         \
+  long ind = name##_find (hash_map, key);                                     \
+  if (ind == -1)                                                              \
+    {                                                                         \
+      return NULL;                                                            \
+    }                                                                         \
+  return &(hash_map->slots[ind].value);                                       \
+}                                                                             \
+                                                                              \
+static inline int name##_erase (name *hash_map, K key)                        \
+{                                                                             \
+  if (hash_map == NULL)                                                       \
+    {                                                                         \
+      return 0;                                                               \
+    }                                                                         \
+  long found = name##_find (hash_map, key);                                   \
+  if (found == -1)                                                            \
+    {                                                                         \
+      return 0;                                                               \
+    }                                                                         \
+  size_t mask = hash_map->capacity - 1;                                       \
+  size_t ind = (size_t) found;                                                \
+  size_t next = (ind + 1) & mask;                                             \
+  while (hash_map->slots[next].dist > 1) /* backward shift deletion */        \
+    {                                                                         \
+      hash_map->slots[ind] = hash_map->slots[next];                           \
+      --hash_map->slots[ind].dist;                                            \
+      ind = next;                                                             \
+      next = (next + 1) & mask;                                               \
+    }                                                                         \
+  hash_map->slots[ind].dist = 0;                                              \
+  --hash_map->size;                                                           \
+  if (name##_get_load_factor (hash_map) < TYPED_HASHMAP_MIN_LOAD_FACTOR       \
+      && hash_map->capacity > TYPED_HASHMAP_MIN_CAP)                          \
+    {                                                                         \
+      name##_resize (hash_map,                                                \
+                     hash_map->capacity / TYPED_HASHMAP_GROWTH_FACTOR);       \
+    }                                                                         \
+  return 1;                                                                   \
+}                                                                             \
+                                                                              \
+static inline int name##_apply_if (const name *hash_map, int (*key_func) (K), \
+                                   void (*val_func) (V *))                    \
+{                                                                             \
+  if (hash_map == NULL || key_func == NULL || val_func == NULL)               \
+    {                                                                         \
+      return -1;                                                              \
+    }                                                                         \
+  int count = 0;                                                              \
+  for (size_t i = 0; i < hash_map->capacity; ++i)                             \
+    {                                                                         \
+      if (hash_map->slots[i].dist != 0                                        \
+          && key_func (hash_map->slots[i].key) == 1)                          \
+        {                                                                     \
+          val_func (&(hash_map->slots[i].value));                             \
+          ++count;                                                            \
+        }                                                                     \
+    }                                                                         \
+  return count;                                                               \
+}
+
+#endif //TYPED_HASHMAP_H_
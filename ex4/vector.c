@@ -1,18 +1,126 @@
+#include <string.h>
 #include "vector.h"
 
 #define VECTOR_MIN_SIZE 1
+#define VECTOR_INSERTION_SORT_MAX 16
 #define VEC_TRUE 1
 #define VEC_FALSE 0
+/**
+ * takes size bytes from the allocator (malloc if NULL)
+ */
+void *mem_alloc (const vector_allocator *allocator, size_t size)
+{
+  if (allocator == NULL)
+    {
+      return malloc (size);
+    }
+  return allocator->alloc (allocator->ctx, size);
+}
+
+/**
+ * gives size bytes taken by mem_alloc back to the allocator
+ */
+void mem_free (const vector_allocator *allocator, void *ptr, size_t size)
+{
+  if (allocator == NULL)
+    {
+      free (ptr);
+      return;
+    }
+  allocator->free (allocator->ctx, ptr, size);
+}
+
+/**
+ * @return the number of bytes an element takes in the vector's data array
+ */
+size_t elem_bytes (const vector *vec)
+{
+  return vec->elem_size == 0 ? sizeof (void *) : vec->elem_size;
+}
+
+/**
+ * @return the address of slot ind of the vector's data array - the element
+ * itself in an inline vector, the pointer to it otherwise
+ */
+char *slot_at (const vector *vec, size_t ind)
+{
+  return (char *) vec->data + ind * elem_bytes (vec);
+}
+
+/**
+ * @return the element held in slot ind
+ */
+void *elem_at (const vector *vec, size_t ind)
+{
+  if (vec->elem_size != 0)
+    {
+      return slot_at (vec, ind);
+    }
+  return vec->data[ind];
+}
+
+/**
+ * frees the element held in slot ind (nothing to free in an inline vector)
+ */
+void free_slot (vector *vec, size_t ind)
+{
+  if (vec->elem_size == 0)
+    {
+      vec->elem_free_func (&(vec->data[ind]));
+    }
+}
+
+/**
+ * changes the capacity of the vector's data array
+ * @param vec given vector, its size must not exceed new_cap
+ * @param new_cap the new capacity
+ * @return 0 if failed (the vector is unchanged), 1 if successful
+ */
+int resize_data (vector *vec, size_t new_cap)
+{
+  void **temp;
+  if (vec->allocator == NULL)
+    {
+      temp = (void **) realloc (vec->data, new_cap * elem_bytes (vec));
+      if (temp == NULL)
+        {
+          return 0;
+        }
+    }
+  else
+    {
+      temp = (void **) mem_alloc (vec->allocator, new_cap * elem_bytes (vec));
+      if (temp == NULL)
+        {
+          return 0;
+        }
+      memcpy (temp, vec->data, vec->size * elem_bytes (vec));
+      mem_free (vec->allocator, vec->data, vec->capacity * elem_bytes (vec));
+    }
+  vec->data = temp;
+  vec->capacity = new_cap;
+  return 1;
+}
+
 vector *
 vector_alloc (vector_elem_cpy elem_copy_func, vector_elem_cmp elem_cmp_func,
               vector_elem_free elem_free_func)
+{
+  return vector_alloc_with_allocator (elem_copy_func, elem_cmp_func,
+                                      elem_free_func, NULL);
+}
+
+vector *vector_alloc_with_allocator (vector_elem_cpy elem_copy_func,
+                                     vector_elem_cmp elem_cmp_func,
+                                     vector_elem_free elem_free_func,
+                                     const vector_allocator *allocator)
 {
   if (elem_copy_func == NULL || elem_free_func == NULL
       || elem_cmp_func == NULL)
     {
       return NULL;
     }
-  vector *result = malloc (sizeof (vector));
+  vector *result = mem_alloc (allocator, sizeof (vector));
   if (result == NULL)
     {
       return NULL;
@@ -20,9 +128,41 @@ vector_alloc (vector_elem_cpy elem_copy_func, vector_elem_cmp elem_cmp_func,
   result->elem_copy_func = elem_copy_func;
   result->elem_cmp_func = elem_cmp_func;
   result->elem_free_func = elem_free_func;
+  result->allocator = allocator;
+  result->elem_size = 0;
+  result->order_func = NULL;
   result->capacity = VECTOR_INITIAL_CAP;
   result->size = 0;
-  result->data = (void **) malloc (sizeof (void *) * VECTOR_INITIAL_CAP);
+  result->data = (void **) mem_alloc (allocator,
+                                      sizeof (void *) * VECTOR_INITIAL_CAP);
+  if (result->data == NULL)
+    {
+      mem_free (allocator, result, sizeof (vector));
+      return NULL;
+    }
+  return result;
+}
+
+vector *vector_alloc_inline (size_t elem_size, vector_elem_cmp elem_cmp_func)
+{
+  if (elem_size == 0)
+    {
+      return NULL;
+    }
+  vector *result = (vector *) malloc (sizeof (vector));
+  if (result == NULL)
+    {
+      return NULL;
+    }
+  result->elem_copy_func = NULL;
+  result->elem_cmp_func = elem_cmp_func;
+  result->elem_free_func = NULL;
+  result->allocator = NULL;
+  result->elem_size = elem_size;
+  result->order_func = NULL;
+  result->capacity = VECTOR_INITIAL_CAP;
+  result->size = 0;
+  result->data = (void **) malloc (elem_size * VECTOR_INITIAL_CAP);
   if (result->data == NULL)
     {
       free (result);
@@ -38,8 +178,10 @@ void vector_free (vector **p_vector)
       return;
     }
   vector_clear (*p_vector);
-  free ((*p_vector)->data);
-  free (*p_vector);
+  const vector_allocator *allocator = (*p_vector)->allocator;
+  mem_free (allocator, (*p_vector)->data,
+            (*p_vector)->capacity * elem_bytes (*p_vector));
+  mem_free (allocator, *p_vector, sizeof (vector));
   *p_vector = NULL;
 }
 
@@ -49,7 +191,7 @@ void *vector_at (const vector *vector, size_t ind)
     {
       return NULL;
     }
-  return vector->data[ind];
+  return elem_at (vector, ind);
 }
 
 int vector_find (const vector *vector, const void *value)
@@ -59,6 +201,21 @@ int vector_find (const vector *vector, const void *value)
       return -1;
     }
   int vec_size = (int) vector->size;
+  if (vector->elem_size != 0)
+    {
+      // a walk over the buffer itself
+      const char *elem = (const char *) vector->data;
+      for (int i = 0; i < vec_size; ++i, elem += vector->elem_size)
+        {
+          if (vector->elem_cmp_func == NULL
+              ? memcmp (elem, value, vector->elem_size) == 0
+              : vector->elem_cmp_func (elem, value) == 1)
+            {
+              return i;
+            }
+        }
+      return -1;
+    }
   for (int i = 0; i < vec_size; ++i)
     {
       if (vector->elem_cmp_func ((vector->data)[i], value) == 1)
@@ -76,39 +233,46 @@ int vector_find (const vector *vector, const void *value)
  */
 int lower_cap (vector *vec)
 {
-  void **temp = realloc (vec->data,
-                         (vec->capacity / VECTOR_GROWTH_FACTOR)
-                         * sizeof (void *));
-  if (temp == NULL)
+  return resize_data (vec, vec->capacity / VECTOR_GROWTH_FACTOR);
+}
+
+/**
+ * extends the capacity of the vector if adding an element would exceed
+ * VECTOR_MAX_LOAD_FACTOR
+ * @param vec given vector
+ * @param p_flag out - set to VEC_TRUE if the capacity was extended
+ * @return 0 if failed, 1 if successful
+ */
+int grow_if_needed (vector *vec, int *p_flag)
+{
+  *p_flag = VEC_FALSE;
+  if (VECTOR_MAX_LOAD_FACTOR <= vector_get_load_factor (vec))
     {
-      return 0;
+      if (resize_data (vec, vec->capacity * VECTOR_GROWTH_FACTOR) == 0)
+        {
+          return 0;
+        }
+      *p_flag = VEC_TRUE;
     }
-  vec->data = temp;
-  temp = NULL;
-  vec->capacity /= VECTOR_GROWTH_FACTOR;
   return 1;
 }
 
 int vector_push_back (vector *vector, const void *value)
 {
-  int flag = VEC_FALSE;
+  int flag;
   if (vector == NULL || value == NULL)
     {
       return 0;
     }
-  if (VECTOR_MAX_LOAD_FACTOR <= vector_get_load_factor (vector))
+  if (grow_if_needed (vector, &flag) == 0)
     {
-      void **temp = realloc (vector->data,
-                             (vector->capacity * VECTOR_GROWTH_FACTOR)
-                             * sizeof (void *));
-      if (temp == NULL)
-        {
-          return 0;
-        }
-      vector->data = temp;
-      temp = NULL;
-      vector->capacity *= VECTOR_GROWTH_FACTOR;
-      flag = VEC_TRUE;
+      return 0;
+    }
+  if (vector->elem_size != 0)
+    {
+      memcpy (slot_at (vector, vector->size), value, vector->elem_size);
+      ++vector->size;
+      return 1;
     }
   void *cpy = vector->elem_copy_func (value);
   if (cpy == NULL)
@@ -124,6 +288,78 @@ int vector_push_back (vector *vector, const void *value)
   return 1;
 }
 
+int vector_push_back_n (vector *vector, const void *const *values, size_t n)
+{
+  if (vector == NULL || values == NULL)
+    {
+      return 0;
+    }
+  for (size_t i = 0; i < n; ++i)
+    {
+      if (values[i] == NULL)
+        {
+          return 0;
+        }
+    }
+  if (vector_reserve (vector, vector->size + n) == 0)
+    {
+      return 0;
+    }
+  size_t start = vector->size;
+  for (size_t i = 0; i < n; ++i)
+    {
+      if (vector->elem_size != 0)
+        {
+          memcpy (slot_at (vector, vector->size), values[i],
+                  vector->elem_size);
+        }
+      else
+        {
+          vector->data[vector->size] = vector->elem_copy_func (values[i]);
+          if (vector->data[vector->size] == NULL)
+            {
+              // all or nothing - drop the copies made so far
+              while (vector->size > start)
+                {
+                  --vector->size;
+                  free_slot (vector, vector->size);
+                }
+              return 0;
+            }
+        }
+      ++vector->size;
+    }
+  return 1;
+}
+
+int vector_push_back_owned (vector *vector, void *value)
+{
+  int flag;
+  if (vector == NULL || value == NULL || vector->elem_size != 0)
+    {
+      return 0;
+    }
+  if (grow_if_needed (vector, &flag) == 0)
+    {
+      return 0;
+    }
+  (vector->data)[vector->size] = value;
+  ++vector->size;
+  return 1;
+}
+
+void *vector_detach_back (vector *vector)
+{
+  if (vector == NULL || vector->size == 0 || vector->elem_size != 0)
+    {
+      return NULL;
+    }
+  --vector->size;
+  void *ptr = vector->data[vector->size];
+  vector->data[vector->size] = NULL;
+  return ptr;
+}
+
 double vector_get_load_factor (const vector *vector)
 {
   if (vector == NULL || vector->capacity == 0)
@@ -138,44 +374,133 @@ double vector_get_load_factor (const vector *vector)
   return result;
 }
 
+/**
+ * halves the capacity of the vector (at most once) after erasing, if its
+ * load factor before the erase was at most VECTOR_MIN_LOAD_FACTOR - the
+ * same rule vector_erase always had. a failed shrink leaves a valid (just
+ * sparse) vector behind.
+ * @param vec given vector
+ * @param old_size the size of the vector before the erase
+ * @return 0 if the shrink failed, 1 otherwise
+ */
+int shrink_after_erase (vector *vec, size_t old_size)
+{
+  if ((double) old_size / vec->capacity <= VECTOR_MIN_LOAD_FACTOR
+      && vec->capacity != VECTOR_MIN_SIZE)
+    {
+      return lower_cap (vec);
+    }
+  return 1;
+}
+
 int vector_erase (vector *vector, size_t ind)
+{
+  return vector_erase_range (vector, ind, ind + 1);
+}
+
+int vector_erase_unordered (vector *vector, size_t ind)
 {
   if (vector == NULL || ind >= vector->size)
     {
       return 0;
     }
-  else
+  free_slot (vector, ind);
+  --vector->size;
+  if (ind != vector->size)
+    {
+      memcpy (slot_at (vector, ind), slot_at (vector, vector->size),
+              elem_bytes (vector));
+    }
+  return shrink_after_erase (vector, vector->size + 1);
+}
+
+int vector_erase_range (vector *vector, size_t first, size_t last)
+{
+  if (vector == NULL || first >= last || last > vector->size)
+    {
+      return 0;
+    }
+  for (size_t i = first; i < last; ++i)
+    {
+      free_slot (vector, i);
+    }
+  memmove (slot_at (vector, first), slot_at (vector, last),
+           (vector->size - last) * elem_bytes (vector));
+  size_t old_size = vector->size;
+  vector->size -= last - first;
+  return shrink_after_erase (vector, old_size);
+}
+
+int vector_erase_if (vector *vector, vector_elem_pred pred)
+{
+  if (vector == NULL || pred == NULL)
+    {
+      return -1;
+    }
+  size_t kept = 0;
+  for (size_t i = 0; i < vector->size; ++i)
     {
-      void *ptr = vector->data[ind];
-      int vector_size = (int) vector->size;
-      for (int i = ind; i < vector_size; ++i)
+      if (pred (elem_at (vector, i)) == 1)
         {
-          if (i == vector_size - 1)
-            {
-              vector->elem_free_func (&ptr);
-              vector->data[vector_size - 1] = NULL;
-              break;
-            }
-          (vector->data)[i] = (vector->data)[i + 1];
+          free_slot (vector, i);
+          continue;
         }
-      if (vector_get_load_factor (vector) <= VECTOR_MIN_LOAD_FACTOR
-          && vector->capacity != VECTOR_MIN_SIZE)
+      if (kept != i)
         {
-          void **temp = realloc (vector->data,
-                                 (vector->capacity / VECTOR_GROWTH_FACTOR)
-                                 * sizeof (void *));
-          if (temp == NULL)
-            {
-              return 0;
-            }
-          vector->data = temp;
-          temp = NULL;
-          vector->capacity /= VECTOR_GROWTH_FACTOR;
+          memcpy (slot_at (vector, kept), slot_at (vector, i),
+                  elem_bytes (vector));
         }
-      --vector->size;
+      ++kept;
     }
-  return 1;
+  int erased = (int) (vector->size - kept);
+  size_t old_size = vector->size;
+  vector->size = kept;
+  if (erased > 0)
+    {
+      shrink_after_erase (vector, old_size); // the erase itself succeeded
+    }
+  return erased;
+}
+
+int vector_reserve (vector *vector, size_t n)
+{
+  if (vector == NULL)
+    {
+      return 0;
+    }
+  size_t new_cap = vector->capacity;
+  // the n-th push sees n - 1 elements in the vector
+  while (n > 0 && (double) (n - 1) / new_cap >= VECTOR_MAX_LOAD_FACTOR)
+    {
+      new_cap *= VECTOR_GROWTH_FACTOR;
+    }
+  if (new_cap == vector->capacity)
+    {
+      return 1;
+    }
+  return resize_data (vector, new_cap);
 }
+
+int vector_shrink_to_fit (vector *vector)
+{
+  if (vector == NULL)
+    {
+      return 0;
+    }
+  size_t new_cap = vector->capacity;
+  while (new_cap / VECTOR_GROWTH_FACTOR >= VECTOR_MIN_SIZE
+         && (double) vector->size / (new_cap / VECTOR_GROWTH_FACTOR)
+            < VECTOR_MAX_LOAD_FACTOR)
+    {
+      new_cap /= VECTOR_GROWTH_FACTOR;
+    }
+  if (new_cap == vector->capacity)
+    {
+      return 1;
+    }
+  return resize_data (vector, new_cap);
+}
+
 /**
  * frees all the data inside the vector
  * @param vec given vector
@@ -184,6 +509,10 @@ void
 remove_vector (vector *vec) // used in order to remove the
 // entire vector data without changing capacity
 {
+  if (vec->elem_size != 0)
+    {
+      return; // nothing is allocated per element
+    }
   int vector_size = (int) vec->size;
   for (int i = 0; i < vector_size; ++i)
     {
@@ -198,13 +527,264 @@ void vector_clear (vector *vector)
     }
   remove_vector (vector);
   vector->size = 0;
-  void **temp = (void **) realloc (vector->data,
-                                   VECTOR_INITIAL_CAP * sizeof (void *));
-  if (temp == NULL)
+  resize_data (vector, VECTOR_INITIAL_CAP);
+}
+
+void vector_clear_keep_capacity (vector *vector)
+{
+  if (vector == NULL)
     {
       return;
     }
-  vector->data = temp;
-  temp = NULL;
-  vector->capacity = VECTOR_INITIAL_CAP;
-}
\ No newline at end of file
+  remove_vector (vector);
+  vector->size = 0;
+}
+
+int vector_set_order (vector *vector, vector_elem_order order_func)
+{
+  if (vector == NULL || order_func == NULL)
+    {
+      return 0;
+    }
+  vector->order_func = order_func;
+  return 1;
+}
+
+/**
+ * @return the order of the elements in slots i and j (see vector_elem_order)
+ */
+int order_slots (const vector *vec, size_t i, size_t j)
+{
+  return vec->order_func (elem_at (vec, i), elem_at (vec, j));
+}
+
+/**
+ * swaps the contents of slots i and j
+ */
+void swap_slots (vector *vec, size_t i, size_t j)
+{
+  if (vec->elem_size == 0)
+    {
+      void *temp = vec->data[i];
+      vec->data[i] = vec->data[j];
+      vec->data[j] = temp;
+      return;
+    }
+  char *a = slot_at (vec, i), *b = slot_at (vec, j), temp;
+  for (size_t k = 0; k < vec->elem_size; ++k)
+    {
+      temp = a[k];
+      a[k] = b[k];
+      b[k] = temp;
+    }
+}
+
+/**
+ * insertion sort of the slots [first, last)
+ */
+void insertion_sort (vector *vec, size_t first, size_t last)
+{
+  for (size_t i = first + 1; i < last; ++i)
+    {
+      for (size_t j = i; j > first && order_slots (vec, j - 1, j) > 0; --j)
+        {
+          swap_slots (vec, j - 1, j);
+        }
+    }
+}
+
+/**
+ * moves the slot at root (of the heap of the n slots starting at first)
+ * down until it is not smaller than its children
+ */
+void sift_down (vector *vec, size_t first, size_t root, size_t n)
+{
+  size_t child;
+  while ((child = 2 * root + 1) < n)
+    {
+      if (child + 1 < n
+          && order_slots (vec, first + child, first + child + 1) < 0)
+        {
+          ++child;
+        }
+      if (order_slots (vec, first + root, first + child) >= 0)
+        {
+          return;
+        }
+      swap_slots (vec, first + root, first + child);
+      root = child;
+    }
+}
+
+/**
+ * heap sort of the slots [first, last)
+ */
+void heap_sort (vector *vec, size_t first, size_t last)
+{
+  size_t n = last - first;
+  for (size_t root = n / 2; root > 0; --root)
+    {
+      sift_down (vec, first, root - 1, n);
+    }
+  for (size_t end = n - 1; end > 0; --end)
+    {
+      swap_slots (vec, first, first + end);
+      sift_down (vec, first, 0, end);
+    }
+}
+
+/**
+ * introsort of the slots [first, last): quicksort with a median of three
+ * pivot, recursing into the smaller part only, until depth_left runs out
+ * (then heap sort) or the range is short (then insertion sort)
+ */
+void intro_sort (vector *vec, size_t first, size_t last, size_t depth_left)
+{
+  while (last - first > VECTOR_INSERTION_SORT_MAX)
+    {
+      if (depth_left == 0)
+        {
+          heap_sort (vec, first, last);
+          return;
+        }
+      --depth_left;
+      // sort first, mid and last - 1, and put the median at first
+      size_t mid = first + (last - first) / 2;
+      if (order_slots (vec, mid, first) < 0)
+        {
+          swap_slots (vec, mid, first);
+        }
+      if (order_slots (vec, last - 1, mid) < 0)
+        {
+          swap_slots (vec, last - 1, mid);
+          if (order_slots (vec, mid, first) < 0)
+            {
+              swap_slots (vec, mid, first);
+            }
+        }
+      swap_slots (vec, first, mid);
+      // Hoare partition around the pivot at first
+      size_t i = first, j = last;
+      for (;;)
+        {
+          while (order_slots (vec, ++i, first) < 0)
+            {
+            }
+          while (order_slots (vec, first, --j) < 0)
+            {
+            }
+          if (i >= j)
+            {
+              break;
+            }
+          swap_slots (vec, i, j);
+        }
+      swap_slots (vec, first, j);
+      // [first, j) <= pivot, slot j holds it, (j, last) >= pivot
+      if (j - first < last - j - 1)
+        {
+          intro_sort (vec, first, j, depth_left);
+          first = j + 1;
+        }
+      else
+        {
+          intro_sort (vec, j + 1, last, depth_left);
+          last = j;
+        }
+    }
+  insertion_sort (vec, first, last);
+}
+
+int vector_sort (vector *vector)
+{
+  if (vector == NULL || vector->order_func == NULL)
+    {
+      return 0;
+    }
+  size_t depth = 0;
+  for (size_t n = vector->size; n > 1; n /= 2)
+    {
+      depth += 2;
+    }
+  intro_sort (vector, 0, vector->size, depth);
+  return 1;
+}
+
+/**
+ * @param upper 0 for the first element not before value, 1 for the first
+ * element after it
+ * @return the index of that element in a sorted vector (size if none)
+ */
+size_t sorted_bound (const vector *vec, const void *value, int upper)
+{
+  size_t low = 0, high = vec->size, mid;
+  int order;
+  while (low < high)
+    {
+      mid = low + (high - low) / 2;
+      order = vec->order_func (elem_at (vec, mid), value);
+      if (order < 0 || (upper && order == 0))
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+  return low;
+}
+
+int vector_bsearch (const vector *vector, const void *value)
+{
+  if (vector == NULL || value == NULL || vector->order_func == NULL)
+    {
+      return -1;
+    }
+  size_t ind = sorted_bound (vector, value, 0);
+  if (ind == vector->size
+      || vector->order_func (elem_at (vector, ind), value) != 0)
+    {
+      return -1;
+    }
+  return (int) ind;
+}
+
+int vector_insert_sorted (vector *vector, const void *value)
+{
+  if (vector == NULL || value == NULL || vector->order_func == NULL)
+    {
+      return 0;
+    }
+  int flag;
+  if (grow_if_needed (vector, &flag) == 0)
+    {
+      return 0;
+    }
+  void *cpy = NULL;
+  if (vector->elem_size == 0)
+    {
+      cpy = vector->elem_copy_func (value);
+      if (cpy == NULL)
+        {
+          if (flag == VEC_TRUE)
+            {
+              lower_cap (vector);
+            }
+          return 0;
+        }
+    }
+  size_t ind = sorted_bound (vector, value, 1);
+  memmove (slot_at (vector, ind + 1), slot_at (vector, ind),
+           (vector->size - ind) * elem_bytes (vector));
+  if (vector->elem_size == 0)
+    {
+      vector->data[ind] = cpy;
+    }
+  else
+    {
+      memcpy (slot_at (vector, ind), value, vector->elem_size);
+    }
+  ++vector->size;
+  return 1;
+}
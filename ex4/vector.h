@@ -50,6 +50,35 @@ typedef int (*vector_elem_cmp) (const void *, const void *);
  */
 typedef void (*vector_elem_free) (void **);
 
+/**
+ * @typedef vector_elem_pred
+ * Function which receives an element of the type stored in the vector
+ * and returns 1 if it fulfills a condition, 0 otherwise.
+ */
+typedef int (*vector_elem_pred) (const void *);
+
+/**
+ * @typedef vector_elem_order
+ * Function which receives two elements of the type stored in the vector
+ * and returns a negative number if the first comes before the second, 0 if
+ * they are equivalent and a positive number otherwise (like qsort's).
+ */
+typedef int (*vector_elem_order) (const void *, const void *);
+
+/**
+ * @struct vector_allocator
+ * The memory a vector takes for itself (the vector struct and its data
+ * array, not the elements) can be drawn from a custom allocator.
+ * @param alloc returns size bytes (aligned like malloc), NULL if failed.
+ * @param free releases size bytes taken by alloc.
+ * @param ctx passed as the first argument to alloc and free.
+ */
+typedef struct vector_allocator {
+    void *(*alloc) (void *ctx, size_t size);
+    void (*free) (void *ctx, void *ptr, size_t size);
+    void *ctx;
+} vector_allocator;
+
 /**
  * @struct vector - a generic vector struct.
  * @param capacity - the capacity of the vector.
@@ -61,6 +90,13 @@ typedef void (*vector_elem_free) (void **);
  * stored in the vector.
  * @param elem_free_func - a function which frees the elements stored
  * in the vector.
+ * @param allocator - the allocator of the vector's own memory, NULL for
+ * malloc / realloc / free.
+ * @param elem_size - 0 for a vector of pointers to elements. Otherwise the
+ * size of the elements of an inline vector (see vector_alloc_inline), whose
+ * data is a single buffer of the elements themselves.
+ * @param order_func - a function which orders the elements stored in the
+ * vector (see vector_set_order), NULL if none was set.
  */
 typedef struct vector {
     size_t capacity;
@@ -69,6 +105,9 @@ typedef struct vector {
     vector_elem_cpy elem_copy_func;
     vector_elem_cmp elem_cmp_func;
     vector_elem_free elem_free_func;
+    const vector_allocator *allocator;
+    size_t elem_size;
+    vector_elem_order order_func;
 } vector;
 
 /**
@@ -83,6 +122,35 @@ typedef struct vector {
 vector *vector_alloc (vector_elem_cpy elem_copy_func, vector_elem_cmp elem_cmp_func,
                       vector_elem_free elem_free_func);
 
+/**
+ * Same as vector_alloc, but the vector struct and its data array are taken
+ * from (and given back to) the given allocator.
+ * @param allocator the allocator, must outlive the vector (NULL - same as
+ * vector_alloc).
+ * @return pointer to a vector allocated with allocator.
+ * @if_fail return NULL.
+ */
+vector *vector_alloc_with_allocator (vector_elem_cpy elem_copy_func,
+                                     vector_elem_cmp elem_cmp_func,
+                                     vector_elem_free elem_free_func,
+                                     const vector_allocator *allocator);
+
+/**
+ * Dynamically allocates a new inline vector, which stores its elements by
+ * value in one contiguous buffer - pushing an element copies its elem_size
+ * bytes, with no allocation of its own, and vector_at returns a pointer
+ * into the buffer (valid until the vector is changed). The elements must
+ * be plain data, they are copied and dropped byte by byte.
+ * vector_push_back_owned and vector_detach_back do not apply to an inline
+ * vector (they fail).
+ * @param elem_size the size of an element, in bytes.
+ * @param elem_cmp_func func which is used to compare elements stored in the
+ * vector (NULL - the elements are compared byte by byte).
+ * @return pointer to dynamically allocated vector.
+ * @if_fail return NULL.
+ */
+vector *vector_alloc_inline (size_t elem_size, vector_elem_cmp elem_cmp_func);
+
 /**
  * Frees a vector and the elements the vector itself allocated.
  * @param p_vector pointer to dynamically allocated pointer to vector.
@@ -94,7 +162,8 @@ void vector_free (vector **p_vector);
  * @param vector pointer to a vector.
  * @param ind the index of the element we want to get.
  * @return the element at the given index if exists (the element itself, not a copy of it),
- * NULL otherwise.
+ * NULL otherwise. For an inline vector, a pointer to the element inside the
+ * vector's buffer.
  */
 void *vector_at (const vector *vector, size_t ind);
 
@@ -115,6 +184,36 @@ int vector_find (const vector *vector, const void *value);
  */
 int vector_push_back (vector *vector, const void *value);
 
+/**
+ * Adds copies of n values to the back of the vector, extending it (once)
+ * beforehand - see vector_reserve.
+ * @param vector a pointer to vector.
+ * @param values an array of n pointers to the values to be added.
+ * @param n the number of values.
+ * @return 1 if all the values have been added, 0 otherwise (then none of
+ * them is added).
+ */
+int vector_push_back_n (vector *vector, const void *const *values, size_t n);
+
+/**
+ * Adds the given element to the back (index vector_size) of the vector
+ * *without* copying it - the vector takes ownership of the element and
+ * frees it with elem_free_func like any other element.
+ * @param vector a pointer to vector.
+ * @param value a dynamically allocated element to be adopted by the vector.
+ * @return 1 if the adding has been done successfully, 0 otherwise (the
+ * element is then still owned by the caller).
+ */
+int vector_push_back_owned (vector *vector, void *value);
+
+/**
+ * Removes the last element of the vector *without* freeing it - the caller
+ * becomes its owner. The capacity of the vector is left untouched.
+ * @param vector a pointer to vector.
+ * @return the removed element, NULL if the vector is empty.
+ */
+void *vector_detach_back (vector *vector);
+
 /**
  * This function returns the load factor of the vector.
  * @param vector a vector.
@@ -131,10 +230,103 @@ double vector_get_load_factor (const vector *vector);
  */
 int vector_erase (vector *vector, size_t ind);
 
+/**
+ * Removes the element at the given index from the vector in O(1) - the
+ * last element takes its place (the order of the elements is not kept).
+ * @param vector a pointer to vector.
+ * @param ind the index of the element to be removed.
+ * @return 1 if the removing has been done successfully, 0 otherwise.
+ */
+int vector_erase_unordered (vector *vector, size_t ind);
+
+/**
+ * Removes the elements at the indices [first, last) from the vector, moving
+ * the following elements back in one go (and shrinking at most once).
+ * @param vector a pointer to vector.
+ * @param first the index of the first element to be removed.
+ * @param last the index after the last element to be removed.
+ * @return 1 if the removing has been done successfully, 0 otherwise (also
+ * if the range is empty or exceeds the vector).
+ */
+int vector_erase_range (vector *vector, size_t first, size_t last);
+
+/**
+ * Removes the elements that fulfill pred from the vector, in a single pass
+ * that keeps the order of the remaining elements (shrinking at most once).
+ * @param vector a pointer to vector.
+ * @param pred a function that checks a condition on an element and returns
+ * 1 if true, 0 else.
+ * @return number of removed elements, -1 on bad input.
+ */
+int vector_erase_if (vector *vector, vector_elem_pred pred);
+
 /**
  * Deletes all the elements in the vector.
  * @param vector vector a pointer to vector.
  */
 void vector_clear (vector *vector);
 
+/**
+ * Deletes all the elements in the vector, keeping its capacity - refilling
+ * it up to the same size triggers no extension.
+ * @param vector vector a pointer to vector.
+ */
+void vector_clear_keep_capacity (vector *vector);
+
+/**
+ * Extends the vector (once) so that it holds n elements without exceeding
+ * VECTOR_MAX_LOAD_FACTOR, i.e. pushing up to n elements triggers no
+ * extension. The vector is never minimized by this function.
+ * @param vector a pointer to vector.
+ * @param n the number of elements the vector should be able to hold.
+ * @return 1 if successful, 0 otherwise.
+ */
+int vector_reserve (vector *vector, size_t n);
+
+/**
+ * Lowers the capacity of the vector as far as possible without a push
+ * extending it right away (a load factor below VECTOR_MAX_LOAD_FACTOR).
+ * @param vector a pointer to vector.
+ * @return 1 if successful (also if the vector could not shrink), 0
+ * otherwise.
+ */
+int vector_shrink_to_fit (vector *vector);
+
+/**
+ * Sets the order of the elements, used by vector_sort, vector_bsearch and
+ * vector_insert_sorted (the elements are not reordered by this function).
+ * @param vector a pointer to vector.
+ * @param order_func func which is used to order the elements stored in the
+ * vector.
+ * @return 1 if successful, 0 otherwise.
+ */
+int vector_set_order (vector *vector, vector_elem_order order_func);
+
+/**
+ * Sorts the elements of the vector by its order, in O(n log n) - an
+ * introsort (quicksort, falling back to heapsort on too deep recursions,
+ * and insertion sort on short ranges). The sort is not stable.
+ * @param vector a pointer to vector with an order.
+ * @return 1 if successful, 0 otherwise.
+ */
+int vector_sort (vector *vector);
+
+/**
+ * Looks for a value in a vector sorted by its order, in O(log n).
+ * @param vector a pointer to a sorted vector with an order.
+ * @param value the value to look for.
+ * @return the index of the first element equivalent to value if there is
+ * one ([0, vector_size - 1]), -1 otherwise.
+ */
+int vector_bsearch (const vector *vector, const void *value);
+
+/**
+ * Adds a new value to a vector sorted by its order, after the elements
+ * equivalent to it - the vector stays sorted.
+ * @param vector a pointer to a sorted vector with an order.
+ * @param value the value to be added to the vector.
+ * @return 1 if the adding has been done successfully, 0 otherwise.
+ */
+int vector_insert_sorted (vector *vector, const void *value);
+
 #endif //VECTOR_H_